@@ -0,0 +1,70 @@
+// *******************************************************************************************************
+// File:      AddressMap.cpp
+// Author:    Aiko Pras
+// History:   2026/01/22 AP Version 1.0
+//            2026/01/24 AP Version 1.1: Independent address ranges per group of 4 channels
+//            2026/02/07 AP Version 1.2: Output mode per channel
+//            2026/02/21 AP Version 1.3: Group addresses that are not aligned are not used
+// 
+// Purpose:   Lookup from accessory output address to channel and relay
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "AddressMap.h"
+#include "core_Functions.h"
+
+addressMap_class addressMap;
+
+
+void addressMap_class::init(void) {
+  uint16_t address = cvValues.storedAddress();
+  bool outputAddr = bitRead(cvValues.read(Config), 6);
+  uint16_t keys[GROUPS];
+  uint8_t values[GROUPS];
+  uint16_t next;                                       // First address of the next group
+  if (address == 65535) next = 0;                      // Address not yet set
+  else if (outputAddr) next = address;                 // Output addressing
+  else next = (address * 4) + 1;                       // Decoder addressing
+  bool aligned = false;                                // Is align known?
+  align = 0;
+  misaligned = 0;
+  for (uint8_t group = 0; group < GROUPS; group++) {
+    uint16_t groupAddr = (cvValues.read(GroupAddr + 2 * group + 1) << 8) | cvValues.read(GroupAddr + 2 * group);
+    if (groupAddr) next = groupAddr;
+    if (next && !aligned) {
+      align = next & 3;
+      aligned = true;
+    }
+    // Unset address: group not used. Not aligned: not used either, and reported
+    bool used = next && ((next & 3) == align);
+    if (next && !used) misaligned |= (1 << group);
+    keys[group] = used ? ((next - align) >> 2) : HASH_EMPTY;
+    values[group] = group;
+    firstOutput[group] = used ? next : 0;
+    if (next) next += 4;
+  }
+  groups.build(keys, values, GROUPS);
+  uint16_t invert = (cvValues.read(InvertH) << 8) | cvValues.read(InvertL);
+  for (uint8_t ch = 0; ch < 16; ch++) {
+    uint8_t relay = cvValues.read(RelayMap + ch);
+    if ((relay < 1) || (relay > 16)) relay = ch + 1;   // Invalid CV value: no remapping
+    uint8_t mode = (cvValues.read(ChannelMode + (ch >> 2)) >> ((ch & 3) << 1)) & 0x03;
+    if (mode > MODE_TOGGLE) mode = MODE_STEADY;
+    entry[ch] = (relay - 1) | (mode << 4) | (bitRead(invert, ch) ? 0x80 : 0);
+  }
+}
+
+
+bool addressMap_class::affectedBy(uint16_t cvNumber) {
+  switch (cvNumber) {
+    case myAddrL:
+    case myAddrH:
+    case Config:
+    case InvertL:
+    case InvertH:
+      return true;
+    default:
+      return ((cvNumber >= RelayMap) && (cvNumber < GroupAddr + 2 * GROUPS)) ||
+             ((cvNumber >= ChannelMode) && (cvNumber < ChannelMode + 4));
+  }
+}
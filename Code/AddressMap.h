@@ -0,0 +1,73 @@
+// *******************************************************************************************************
+// File:      AddressMap.h
+// Author:    Aiko Pras
+// History:   2026/01/22 AP Version 1.0
+//            2026/01/24 AP Version 1.1: Independent address ranges per group of 4 channels
+//            2026/02/07 AP Version 1.2: Output mode per channel
+//            2026/02/21 AP Version 1.3: Group addresses that are not aligned are not used
+// 
+// Purpose:   Lookup from accessory output address to channel and relay
+//
+// The 16 channels are divided into four groups of 4 (channel 1..4, 5..8, 9..12 and 13..16).
+// Each group listens to 4 consecutive output addresses, starting at the address in its group CVs
+// (CV56..63, low and high byte). A group with address 0 (the default) follows the previous group;
+// group 1 then starts at the address given by CV1/CV9/CV29. Without group CVs the board thus
+// behaves as four consecutive accessory decoders.
+// Each channel drives one relay, which may be remapped (CV40..55) and inverted (CV36/37).
+// Each channel also has an output mode (CV71..74, 2 bits per channel, channel 1 in bit 0..1 of CV71):
+// - MODE_STEADY: + energises the relay, - releases it
+// - MODE_PULSE:  + energises the relay for CV75 x 10ms (see Pulses.h), - releases it immediately
+// - MODE_TOGGLE: + changes the relay state, - is ignored
+// Inverted channels swap + and - before the mode is applied.
+//
+// Deriving all this from the CVs takes many EEPROM reads. init() therefore does this once and
+// stores the result in RAM. The groups are found through a perfect hash (core_PerfectHash), whose
+// key is the block of 4 output addresses. channel() thus costs a subtraction, a multiplication
+// and a compare per packet, independent of the number of groups or how they are spread.
+// init() should be called again after any of these CVs has been changed (see affectedBy()).
+//
+// The lookup has a single alignment: all groups should start on the same block boundary as the
+// first group with an address, thus their addresses should be equal modulo 4. In decoder
+// addressing mode the first output of a decoder (1, 5, 9, ...) keeps a group aligned. A group
+// whose address is not aligned is not used, and is reported in `misaligned`; rounding it to the
+// nearest block would let it answer to addresses that were never configured.
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "core_PerfectHash.h"
+
+#define NO_CHANNEL  0xFF
+#define GROUPS      4
+
+// Output modes
+#define MODE_STEADY 0
+#define MODE_PULSE  1
+#define MODE_TOGGLE 2
+
+class addressMap_class {
+  public:
+    void init(void);                          // Builds the lookup from the CVs
+    bool affectedBy(uint16_t cvNumber);       // Should init() be called after this CV has changed?
+
+    // Returns the channel (0..15) for this output address, or NO_CHANNEL if it is not ours
+    uint8_t channel(uint16_t outputAddress) {
+      uint16_t index = outputAddress - align;
+      uint8_t group = groups.lookup(index >> 2);
+      if (group == HASH_NOT_FOUND) return NO_CHANNEL;
+      return (group << 2) | (index & 3);
+    }
+    uint8_t relay(uint8_t channel) {return entry[channel] & 0x0F;}
+    bool inverted(uint8_t channel) {return entry[channel] & 0x80;}
+    uint8_t mode(uint8_t channel) {return (entry[channel] >> 4) & 0x03;}
+
+    uint16_t firstOutput[GROUPS];             // Output address of the first channel of each group. 0: not used
+    uint8_t misaligned;                       // Bit n: group n+1 is not used, its address is not aligned
+
+  private:
+    uint8_t align;                            // Output address - align is a multiple of 4 for channel 1
+    PerfectHash<3> groups;                    // Block of 4 output addresses => group
+    uint8_t entry[16];                        // bit 0..3: relay, bit 4..5: mode, bit 7: inverted
+};
+
+extern addressMap_class addressMap;
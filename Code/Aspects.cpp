@@ -0,0 +1,52 @@
+// *******************************************************************************************************
+// File:      Aspects.cpp
+// Author:    Aiko Pras
+// History:   2026/01/28 AP Version 1.0
+// 
+// Purpose:   Extended accessory (signal aspect) commands, mapped to relay patterns
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Aspects.h"
+#include "Relays.h"
+#include "core_Functions.h"
+
+aspects_class aspects;
+
+
+void aspects_class::init(void) {
+  uint16_t keys[MAX_SIGNALS];
+  uint8_t values[MAX_SIGNALS];
+  number = 0;
+  for (uint8_t signal = 0; signal < MAX_SIGNALS; signal++) {
+    uint16_t cv = AspectTable + signal * SIGNAL_SIZE;
+    uint16_t address = (cvValues.read(cv + 1) << 8) | cvValues.read(cv);
+    mask[signal] = (cvValues.read(cv + 3) << 8) | cvValues.read(cv + 2);
+    for (uint8_t aspect = 0; aspect < MAX_ASPECTS; aspect++) {
+      uint16_t cvAspect = cv + 4 + 2 * aspect;
+      value[signal][aspect] = (cvValues.read(cvAspect + 1) << 8) | cvValues.read(cvAspect);
+    }
+    if ((address == 0) || (address > 2048)) keys[signal] = HASH_EMPTY;
+    else {
+      keys[signal] = address;
+      number++;
+    }
+    values[signal] = signal;
+  }
+  signals.build(keys, values, MAX_SIGNALS);
+}
+
+
+bool aspects_class::affectedBy(uint16_t cvNumber) {
+  return ((cvNumber >= AspectTable) && (cvNumber < AspectTable + MAX_SIGNALS * SIGNAL_SIZE));
+}
+
+
+bool aspects_class::apply(uint8_t signal, uint8_t aspect) {
+  if (aspect >= MAX_ASPECTS) {
+    unknownAspects++;
+    return false;
+  }
+  relays.apply(mask[signal], value[signal][aspect]);
+  return true;
+}
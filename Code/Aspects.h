@@ -0,0 +1,49 @@
+// *******************************************************************************************************
+// File:      Aspects.h
+// Author:    Aiko Pras
+// History:   2026/01/28 AP Version 1.0
+// 
+// Purpose:   Extended accessory (signal aspect) commands, mapped to relay patterns
+//
+// RCN-213 extended accessory packets carry an output address and an 8-bit aspect. A signal that
+// is driven by several relays can thus be switched by one packet, instead of one basic packet per
+// relay, and without intermediate states being visible on the layout.
+//
+// An aspect table in EEPROM (CV176..255) holds up to MAX_SIGNALS signals of 20 bytes each:
+//   byte 0, 1:   output address of the signal (low, high). 0 or above 2048: not used
+//   byte 2, 3:   relay mask (low = relay 1..8, high = relay 9..16)
+//   byte 4..19:  relay values (low, high) for aspect 0..7
+// If the aspect for an address in the table is received, the relays in the mask are set to the
+// value for that aspect as a single update of the relay image (relays.apply()). Aspects above
+// MAX_ASPECTS - 1 are ignored and counted.
+//
+// init() reads the table once, and builds a perfect hash from address to signal; lookup() is
+// therefore constant-time. init() should be called again after a CV in the aspect table has been
+// changed (see affectedBy()).
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "core_PerfectHash.h"
+
+#define MAX_SIGNALS       4
+#define MAX_ASPECTS       8
+#define SIGNAL_SIZE       (4 + 2 * MAX_ASPECTS)
+#define NO_SIGNAL         HASH_NOT_FOUND
+
+class aspects_class {
+  public:
+    void init(void);
+    bool affectedBy(uint16_t cvNumber);
+    uint8_t lookup(uint16_t outputAddress) {return signals.lookup(outputAddress);}
+    bool apply(uint8_t signal, uint8_t aspect);   // false if the aspect is not in the table
+    uint8_t number;                               // Number of signals in use
+    uint16_t unknownAspects;                      // Aspects that are not in the table
+
+  private:
+    PerfectHash<3> signals;                       // Output address => signal
+    uint16_t mask[MAX_SIGNALS];
+    uint16_t value[MAX_SIGNALS][MAX_ASPECTS];
+};
+
+extern aspects_class aspects;
@@ -0,0 +1,189 @@
+// *******************************************************************************************************
+// File:      Benchmark.cpp
+// Author:    Aiko Pras
+// History:   2026/02/15 AP Version 1.0
+//
+// Purpose:   Microbenchmarks of the hot paths of the decoder (see Benchmark.h)
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Benchmark.h"
+
+#ifdef TMC_BENCHMARK
+#include "core_Functions.h"
+#include "Relays.h"
+
+benchmark_class benchmark;
+
+
+//*****************************************************************************************************
+// Backend for the board: TCB3
+//*****************************************************************************************************
+#ifndef TMC_HOST
+const char benchBackend[] = "tcb3";
+const char benchUnit[] = "cycles";
+
+static volatile uint16_t overflows;
+
+ISR(TCB3_INT_vect) {
+  overflows++;
+  TCB3.INTFLAGS = TCB_CAPT_bm;
+}
+
+
+void benchClockInit(void) {
+  TCB3.CTRLA = 0;
+  TCB3.CTRLB = TCB_CNTMODE_INT_gc;            // Periodic interrupt mode
+  TCB3.CCMP = 0xFFFF;                         // Overflow every 65536 cycles
+  TCB3.CNT = 0;
+  TCB3.INTFLAGS = TCB_CAPT_bm;
+  TCB3.INTCTRL = TCB_CAPT_bm;
+  TCB3.CTRLA = TCB_CLKSEL_DIV1_gc | TCB_ENABLE_bm;
+}
+
+
+uint32_t benchClockNow(void) {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t count = TCB3.CNT;
+  uint16_t high = overflows;
+  // An overflow that occurred after cli() has not been counted by the ISR yet
+  if ((TCB3.INTFLAGS & TCB_CAPT_bm) && (count < 0x8000)) high++;
+  SREG = oldSREG;
+  return ((uint32_t)high << 16) | count;
+}
+#endif
+
+
+//*****************************************************************************************************
+// The functions under test
+//*****************************************************************************************************
+static FlashLed flashLed;
+static FadeOutLed fadeOutLed;
+static DccButton button;
+static DccTimer timer;
+
+
+static void benchEmpty(void) {
+}
+
+
+static void benchStoredAddress(void) {
+  cvValues.storedAddress();
+}
+
+
+static void benchRead(void) {
+  cvValues.read(Config);
+}
+
+
+static void benchProcessMessage(void) {
+  cvProgramming.processMessage(Dcc::MyPomCmd);
+}
+
+
+static void benchFlashLed(void) {
+  flashLed.update();
+}
+
+
+static void benchFadeOutLed(void) {
+  fadeOutLed.update();
+}
+
+
+static void benchButton(void) {
+  button.read();
+}
+
+
+static void benchTimer(void) {
+  timer.expired();
+}
+
+
+static void benchShortcut(void) {
+  relays.adc.shortcut(ADC_RELAY1);
+}
+
+
+static void setCv(CvAccess::operation_t operation) {
+  cvCmd.operation = operation;
+  cvCmd.number = Config;
+  cvCmd.value = cvValues.read(Config);
+  // Bit manipulation: write bit 0 with the value it already has
+  cvCmd.writecmd = 1;
+  cvCmd.bitposition = 0;
+  cvCmd.bitvalue = cvCmd.value & 0x01;
+}
+
+
+void benchmark_class::run(uint16_t calls) {
+  benchClockInit();
+  flashLed.attach(LED_PROG);
+  flashLed.flashFast();
+  fadeOutLed.attach(LED_PROG);
+  fadeOutLed.fadeOut();
+  button.attach(buttonPin);
+  timer.setTime(60000);
+  timer.start();
+
+  Serial.print("{\"suite\":\"tmc16\",\"backend\":\"");
+  Serial.print(benchBackend);
+  Serial.print("\",\"unit\":\"");
+  Serial.print(benchUnit);
+  Serial.print("\",\"f_cpu\":");
+  Serial.print(F_CPU);
+  Serial.println("}");
+
+  uint32_t overhead = measure(benchEmpty, calls);
+  report("CvValues::storedAddress", measure(benchStoredAddress, calls), overhead, calls);
+  report("CvValues::read", measure(benchRead, calls), overhead, calls);
+  setCv(CvAccess::verifyByte);
+  report("CvProgramming::processMessage(verifyByte)", measure(benchProcessMessage, calls), overhead, calls);
+  setCv(CvAccess::writeByte);
+  report("CvProgramming::processMessage(writeByte)", measure(benchProcessMessage, calls), overhead, calls);
+  setCv(CvAccess::bitManipulation);
+  report("CvProgramming::processMessage(bitManipulation)", measure(benchProcessMessage, calls), overhead, calls);
+  report("FlashLed::update", measure(benchFlashLed, calls), overhead, calls);
+  report("FadeOutLed::update", measure(benchFadeOutLed, calls), overhead, calls);
+  report("DccButton::read", measure(benchButton, calls), overhead, calls);
+  report("DccTimer::expired", measure(benchTimer, calls), overhead, calls);
+  report("adc_class::shortcut", measure(benchShortcut, calls), overhead, calls);
+
+  flashLed.turn_off();
+}
+
+
+//*****************************************************************************************************
+// Measurement and report
+//*****************************************************************************************************
+uint32_t benchmark_class::measure(void (*function)(void), uint16_t calls) {
+  uint32_t best = 0xFFFFFFFF;
+  for (uint8_t round = 0; round < BENCH_ROUNDS; round++) {
+    uint32_t start = benchClockNow();
+    for (uint16_t i = 0; i < calls; i++) function();
+    uint32_t total = benchClockNow() - start;
+    if (total < best) best = total;
+  }
+  return best;
+}
+
+
+void benchmark_class::report(const char *name, uint32_t total, uint32_t overhead, uint16_t calls) {
+  uint32_t net = (total > overhead) ? total - overhead : 0;
+  Serial.print("{\"bench\":\"");
+  Serial.print(name);
+  Serial.print("\",\"unit\":\"");
+  Serial.print(benchUnit);
+  Serial.print("\",\"calls\":");
+  Serial.print(calls);
+  Serial.print(",\"total\":");
+  Serial.print(net);
+  Serial.print(",\"per_call\":");
+  Serial.print((double)net / calls, 2);
+  Serial.println("}");
+}
+
+#endif
@@ -0,0 +1,55 @@
+// *******************************************************************************************************
+// File:      Benchmark.h
+// Author:    Aiko Pras
+// History:   2026/02/15 AP Version 1.0
+//
+// Purpose:   Microbenchmarks of the hot paths of the decoder, on the board and on the host
+//
+// The suite is only compiled if TMC_BENCHMARK is defined (MyDefaults.h; the host build always
+// defines it). benchmark.run() calls each function `calls` times in a row, BENCH_ROUNDS times, and
+// prints per function one line of JSON over Serial, with the best of these rounds:
+//   {"bench":"CvValues::read","unit":"cycles","calls":1000,"total":52000,"per_call":48.50}
+// The time of the benchmark loop itself (measured with an empty function) is subtracted. The
+// first line describes the run: {"suite":"tmc16","backend":"tcb3","unit":"cycles","f_cpu":24000000}.
+// One JSON object per line allows the results of successive commits to be compared by a script.
+//
+// The clock is the backend:
+// - On the board TCB3 counts CLK_PER cycles; its overflow interrupt extends the count to 32 bit.
+//   Interrupts stay enabled, so the rounds that an ISR (DCC, tick) hit are filtered by taking the
+//   best round. The suite should run instead of the decoder: from setup(), after the hardware has
+//   been initialised, and before any DCC command arrives.
+// - On the host (TMC_HOST) the clock counts nanoseconds (HostBenchmark.cpp). These results
+//   include the cost of the mocks, and are only comparable between host runs.
+//
+// The functions are measured in the state a running decoder normally has: no EEPROM write in
+// progress, LEDs flashing or fading, timers running, button released. The CV operations use PoM;
+// writes store the value the CV already has, so that the EEPROM is not written (and not worn).
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "MyDefaults.h"
+
+#ifdef TMC_BENCHMARK
+
+#define BENCH_CALLS     1000                  // Default number of calls per round
+#define BENCH_ROUNDS    5
+
+// Backend
+void benchClockInit(void);
+uint32_t benchClockNow(void);                 // Wraps around; differences are valid
+extern const char benchBackend[];
+extern const char benchUnit[];
+
+class benchmark_class {
+  public:
+    void run(uint16_t calls = BENCH_CALLS);
+
+  private:
+    uint32_t measure(void (*function)(void), uint16_t calls);   // Best round
+    void report(const char *name, uint32_t total, uint32_t overhead, uint16_t calls);
+};
+
+extern benchmark_class benchmark;
+
+#endif
@@ -0,0 +1,61 @@
+// *******************************************************************************************************
+// File:      Bulk.cpp
+// Author:    Aiko Pras
+// History:   2026/02/01 AP Version 1.0
+//            2026/02/20 AP Version 1.1: All off stops scripts and pulses, and ignores interlocking
+// 
+// Purpose:   Bulk operations on all relays: via accessory broadcasts and a group address
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Bulk.h"
+#include "Relays.h"
+#include "Sequencer.h"
+#include "core_Functions.h"
+
+bulk_class bulk;
+
+
+void bulk_class::init(void) {
+  groupAddress = (cvValues.read(BulkAddrH) << 8) | cvValues.read(BulkAddrL);
+  if (groupAddress > 2045) groupAddress = 0;
+  defaultImage = (cvValues.read(DefaultH) << 8) | cvValues.read(DefaultL);
+}
+
+
+bool bulk_class::affectedBy(uint16_t cvNumber) {
+  return ((cvNumber >= BulkAddrL) && (cvNumber <= DefaultH));
+}
+
+
+uint8_t bulk_class::operation(uint16_t decoderAddress, uint16_t outputAddress, uint8_t position) {
+  uint8_t output;
+  if (decoderAddress == BROADCAST_DECODER) output = (outputAddress - 1) & 3;
+  else if (groupAddress && (outputAddress >= groupAddress) && (outputAddress < groupAddress + 4))
+    output = outputAddress - groupAddress;
+  else return NO_BULK;
+  uint8_t op = (output << 1) | position;
+  if (op > BULK_SAVE) return NO_BULK;
+  return op;
+}
+
+
+void bulk_class::apply(uint8_t operation) {
+  switch (operation) {
+    case BULK_ALL_OFF:
+      // Repeated all-off packets should not overwrite the snapshot
+      if (relays.image) snapshot = relays.image;
+      sequencer.stopAll();
+      relays.releaseAll();
+    break;
+    case BULK_RESTORE:
+      relays.apply(0xFFFF, snapshot);
+    break;
+    case BULK_DEFAULT:
+      relays.apply(0xFFFF, defaultImage);
+    break;
+    case BULK_SAVE:
+      snapshot = relays.image;
+    break;
+  }
+}
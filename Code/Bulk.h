@@ -0,0 +1,53 @@
+// *******************************************************************************************************
+// File:      Bulk.h
+// Author:    Aiko Pras
+// History:   2026/02/01 AP Version 1.0
+//            2026/02/20 AP Version 1.1: All off stops scripts and pulses, and ignores interlocking
+// 
+// Purpose:   Bulk operations on all relays: via accessory broadcasts and a group address
+//
+// Bulk operations act on all 16 relays with a single update of the relay image (relays.apply()).
+// They are triggered by basic accessory commands to:
+// - the broadcast accessory decoder (decoder address 511), which is received by every board, or
+// - the four output addresses starting at the group address in CV67/68 (0: no group address).
+//   Several boards may share the same group address.
+// The output (1..4) and position (- / +) select the operation:
+//   output 1 -:  all off. The current image is saved as snapshot first (unless all are off already)
+//                Running scripts are stopped, so that they don't switch relays on again, pulses
+//                end, and interlocking rules are not checked (relays.releaseAll())
+//   output 1 +:  restore the snapshot
+//   output 2 -:  all to the default image in CV69/70 (bit n = relay n+1)
+//   output 2 +:  save the current image as snapshot
+// Outputs 3 and 4 are reserved. Deactivate packets are ignored.
+//
+// The snapshot is held in RAM, and is therefore lost after a restart.
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+#define BROADCAST_DECODER   511
+#define NO_BULK             0xFF
+
+// Operations; the value is (output - 1) * 2 + position
+#define BULK_ALL_OFF        0
+#define BULK_RESTORE        1
+#define BULK_DEFAULT        2
+#define BULK_SAVE           3
+
+class bulk_class {
+  public:
+    uint16_t snapshot;                        // Saved relay image
+
+    void init(void);                          // Reads the CVs
+    bool affectedBy(uint16_t cvNumber);       // Should init() be called after this CV has changed?
+    // Returns the operation for this accessory command, or NO_BULK if it is not a bulk command
+    uint8_t operation(uint16_t decoderAddress, uint16_t outputAddress, uint8_t position);
+    void apply(uint8_t operation);
+
+  private:
+    uint16_t groupAddress;                    // First output address of the group. 0: none
+    uint16_t defaultImage;
+};
+
+extern bulk_class bulk;
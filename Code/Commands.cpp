@@ -0,0 +1,344 @@
+// *******************************************************************************************************
+// File:      Commands.cpp
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//            2026/01/20 AP Version 1.1: Repeated commands are suppressed
+//            2026/01/22 AP Version 1.2: Output addresses are mapped by addressMap
+//            2026/01/26 AP Version 1.3: Routes
+//            2026/01/28 AP Version 1.4: Extended accessory (signal aspect) commands
+//            2026/01/30 AP Version 1.5: Function decoder mode
+//            2026/02/01 AP Version 1.6: Broadcast and group (bulk) commands
+//            2026/02/05 AP Version 1.7: Scripts
+//            2026/02/07 AP Version 1.8: Output modes (steady, pulse, toggle)
+//            2026/02/20 AP Version 1.9: Dedup entries expire, and are forgotten if the relay changes
+//            2026/02/21 AP Version 1.10: Group addresses that are not aligned are reported
+// 
+// Purpose:   Reception of DCC commands and their execution on the relays
+//
+// The board acts as four consecutive accessory decoders; each output address is a channel that
+// drives one relay (see AddressMap.h). Position 1 (+ / thrown) energises the relay, position 0
+// (- / straight) releases it, unless the channel is inverted or in pulse or toggle mode
+// (see AddressMap.h).
+// Packets with the activate flag cleared are ignored, since the relays keep their state.
+//
+// AP_DCC_library reports basic and extended accessory packets both as (My/Any)AccessoryCmd.
+// For extended packets accCmd.command is Accessory::extended, and accCmd.signalAspect holds
+// the aspect.
+//
+// Function group packets for our loco address are reported as MyLocoF0F4Cmd ... MyLocoF21F28Cmd,
+// with the states in locoCmd.F0F4 ... locoCmd.F21F28. F0F4 follows the packet layout: F1..F4 in
+// bit 0..3 and F0 in bit 4.
+//
+// ******************************************************************************************************
+#include "Commands.h"
+
+commands_class commands;
+
+
+void commandsTick(void) {
+  commands.expire();
+}
+
+
+void commands_class::init(void) {
+  printDetails = cvValues.read(PrintDetails);
+  dedupWindow = cvValues.read(DedupTime) * 10;
+  for (uint8_t ch = 0; ch < NUMBER_OF_RELAYS; ch++) {
+    lastPosition[0][ch] = 0xFF;
+    lastPosition[1][ch] = 0xFF;
+  }
+  if (!registered) registered = tickScheduler.add(commandsTick);
+  initAddressMap();
+  routes.init();
+  aspects.init();
+  locoFunctions.init();
+  bulk.init();
+  sequencer.init();
+  pulses.init();
+  if (locoFunctions.address) locoCmd.setMyAddress(locoFunctions.address);
+  relays.init(cvValues.read(Shortcut), printDetails);
+}
+
+
+void commands_class::update(void) {
+  receive();
+  execute();
+}
+
+
+//*****************************************************************************************************
+// Producer
+//*****************************************************************************************************
+void commands_class::receive(void) {
+  if (!dcc.input()) return;
+  switch (dcc.cmdType) {
+    case Dcc::MyAccessoryCmd:
+    case Dcc::AnyAccessoryCmd: {
+      AccCommand cmd;
+      cmd.outputAddress = accCmd.outputAddress;
+      if (accCmd.command == Accessory::extended) {
+        cmd.kind = CMD_EXTENDED;
+        cmd.position = accCmd.signalAspect;
+        cmd.activate = 1;
+      }
+      else {
+        uint8_t op = bulk.operation(accCmd.decoderAddress, accCmd.outputAddress, accCmd.position);
+        cmd.kind = (op == NO_BULK) ? CMD_BASIC : CMD_BULK;
+        cmd.position = (op == NO_BULK) ? accCmd.position : op;
+        cmd.activate = accCmd.activate;
+      }
+      cmd.time = tickScheduler.ms();
+      queue.push(cmd);
+    }
+    break;
+    case Dcc::MyLocoF0F4Cmd:
+      pushFunctions(FG_F0_F4, ((locoCmd.F0F4 & 0x0F) << 1) | ((locoCmd.F0F4 >> 4) & 0x01));
+    break;
+    case Dcc::MyLocoF5F8Cmd:
+      pushFunctions(FG_F5_F8, locoCmd.F5F8);
+    break;
+    case Dcc::MyLocoF9F12Cmd:
+      pushFunctions(FG_F9_F12, locoCmd.F9F12);
+    break;
+    case Dcc::MyLocoF13F20Cmd:
+      pushFunctions(FG_F13_F20, locoCmd.F13F20);
+    break;
+    case Dcc::MyLocoF21F28Cmd:
+      pushFunctions(FG_F21_F28, locoCmd.F21F28);
+    break;
+    case Dcc::MyPomCmd:
+    case Dcc::SmCmd:
+      cvProgramming.processMessage(dcc.cmdType);
+      // Rebuild the lookups if a CV they are built from may have changed
+      if (cvCmd.operation != CvAccess::verifyByte) {
+        if (addressMap.affectedBy(cvCmd.number)) initAddressMap();
+        if (routes.affectedBy(cvCmd.number)) routes.init();
+        if (aspects.affectedBy(cvCmd.number)) aspects.init();
+        if (locoFunctions.affectedBy(cvCmd.number)) locoFunctions.initMapping();
+        if (bulk.affectedBy(cvCmd.number)) bulk.init();
+        if (interlock.affectedBy(cvCmd.number)) interlock.init();
+        if (sequencer.affectedBy(cvCmd.number)) sequencer.init();
+        if (cvCmd.number == PulseTime) pulses.init();
+      }
+    break;
+    default:
+    break;
+  }
+}
+
+
+void commands_class::initAddressMap(void) {
+  addressMap.init();
+  if (printDetails && addressMap.misaligned) {
+    Serial.print("Address map: group address not aligned with the first group, not used ");
+    Serial.println(addressMap.misaligned, BIN);
+  }
+}
+
+
+// Function packets are only ours in function decoder mode; otherwise our loco address is for PoM
+void commands_class::pushFunctions(uint8_t group, uint8_t bits) {
+  if (!locoFunctions.address) return;
+  AccCommand cmd;
+  cmd.outputAddress = bits;
+  cmd.kind = CMD_FUNCTIONS;
+  cmd.position = group;
+  cmd.activate = 1;
+  cmd.time = tickScheduler.ms();
+  queue.push(cmd);
+}
+
+
+//*****************************************************************************************************
+// Consumer
+//*****************************************************************************************************
+void commands_class::execute(void) {
+  AccCommand cmd;
+  while (queue.pop(cmd)) {
+    if (cmd.kind == CMD_EXTENDED) executeAspect(cmd);
+    else if (cmd.kind == CMD_FUNCTIONS) executeFunctions(cmd);
+    else if (cmd.kind == CMD_BULK) executeBulk(cmd);
+    else executeBasic(cmd);
+    receive();                          // Don't let packets wait in the DCC library
+  }
+  if (printDetails) printQueueStatistics();
+}
+
+
+void commands_class::executeBasic(const AccCommand &cmd) {
+  uint8_t ch = addressMap.channel(cmd.outputAddress);
+  forgetChanged();
+  if (ch == NO_CHANNEL) {}                                      // Not for us
+  else if (isRepetition(ch, cmd)) suppressed++;
+  else if (!cmd.activate) deactivates++;
+  else {
+    // A command that was not carried out is not remembered, so that a re-send is executed
+    if (!setChannel(ch, cmd.position ^ addressMap.inverted(ch))) lastPosition[1][ch] = 0xFF;
+    relays.changed &= ~((uint16_t)1 << addressMap.relay(ch));  // Our own change
+    accLed.activity();
+    if (printDetails) printCommand(cmd, ch);
+  }
+  if (cmd.activate && routes.number) {
+    uint8_t route = routes.lookup(cmd.outputAddress, cmd.position);
+    if (route != NO_ROUTE) executeRoute(cmd, route);
+  }
+  if (cmd.activate) executeScript(cmd);
+}
+
+
+// Returns false if the relay did not end up as intended (interlocking rule or shortcut)
+bool commands_class::setChannel(uint8_t ch, bool on) {
+  uint8_t relay = addressMap.relay(ch);
+  bool was = relays.isOn(relay);
+  switch (addressMap.mode(ch)) {
+    case MODE_PULSE:
+      if (on) pulses.start(relay);
+      else pulses.stop(relay);
+    break;
+    case MODE_TOGGLE:
+      if (!on) return true;
+      relays.set(relay, !was);
+    return (relays.isOn(relay) != was);
+    default:
+      relays.set(relay, on);
+    break;
+  }
+  return (relays.isOn(relay) == on);
+}
+
+
+// Returns true if the same command was received for this relay within the dedup window.
+bool commands_class::isRepetition(uint8_t ch, const AccCommand &cmd) {
+  uint8_t act = cmd.activate ? 1 : 0;
+  uint16_t elapsed = cmd.time - lastTime[act][ch];
+  bool repetition = (cmd.position == lastPosition[act][ch]) && (elapsed < dedupWindow);
+  lastPosition[act][ch] = cmd.position;
+  lastTime[act][ch] = cmd.time;        // A series of repetitions extends the window
+  return repetition;
+}
+
+
+// Forgets the entries of channels whose relay was changed by something else than executeBasic()
+void commands_class::forgetChanged(void) {
+  uint16_t changed = relays.changed;
+  if (!changed) return;
+  relays.changed = 0;
+  for (uint8_t ch = 0; ch < NUMBER_OF_RELAYS; ch++) {
+    if (!((changed >> addressMap.relay(ch)) & 1)) continue;
+    lastPosition[0][ch] = 0xFF;
+    lastPosition[1][ch] = 0xFF;
+  }
+}
+
+
+void commands_class::expire(void) {
+  uint16_t now = tickScheduler.ms();
+  for (uint8_t act = 0; act < 2; act++) {
+    for (uint8_t ch = 0; ch < NUMBER_OF_RELAYS; ch++) {
+      if (lastPosition[act][ch] == 0xFF) continue;
+      if ((uint16_t)(now - lastTime[act][ch]) >= dedupWindow) lastPosition[act][ch] = 0xFF;
+    }
+  }
+}
+
+
+void commands_class::executeRoute(const AccCommand &cmd, uint8_t route) {
+  // Repetitions of the trigger don't change the relays, and are therefore not shown
+  uint16_t before = relays.image;
+  routes.apply(route);
+  if (relays.image == before) return;
+  accLed.activity();
+  if (printDetails) printChange(cmd, " Route ", route + 1);
+}
+
+
+void commands_class::executeScript(const AccCommand &cmd) {
+  // Repetitions of the trigger would start the script again; they are therefore ignored while it
+  // runs, and within the DedupTime window after it started (Sequencer.h)
+  sequencer.input(cmd.outputAddress, cmd.position);
+  uint8_t script = sequencer.lookup(cmd.outputAddress, cmd.position);
+  if ((script == NO_SCRIPT) || sequencer.ignores(script)) return;
+  sequencer.start(script);
+  if (printDetails) printChange(cmd, " Script ", script + 1);
+}
+
+
+void commands_class::executeAspect(const AccCommand &cmd) {
+  if (!aspects.number) return;
+  uint8_t signal = aspects.lookup(cmd.outputAddress);
+  if (signal == NO_SIGNAL) return;
+  uint16_t before = relays.image;
+  aspects.apply(signal, cmd.position);
+  if (relays.image == before) return;
+  accLed.activity();
+  if (printDetails) printChange(cmd, " Aspect ", cmd.position);
+}
+
+
+void commands_class::executeFunctions(const AccCommand &cmd) {
+  // Function packets are repeated continuously; only changes are shown
+  uint16_t before = relays.image;
+  locoFunctions.apply(cmd.position, cmd.outputAddress);
+  if (relays.image == before) return;
+  accLed.activity();
+  if (printDetails) {
+    Serial.print("Loco: ");
+    Serial.print(locoFunctions.address);
+    Serial.print(" Function group ");
+    Serial.print(cmd.position + 1);
+    Serial.print(" Relays ");
+    Serial.println(relays.image, BIN);
+  }
+}
+
+
+void commands_class::executeBulk(const AccCommand &cmd) {
+  if (!cmd.activate) return;
+  uint16_t before = relays.image;
+  bulk.apply(cmd.position);
+  if (relays.image == before) return;
+  accLed.activity();
+  if (printDetails) printChange(cmd, " Bulk ", cmd.position);
+}
+
+
+void commands_class::printChange(const AccCommand &cmd, const char *what, uint8_t number) {
+  Serial.print("Acc: ");
+  Serial.print(cmd.outputAddress);
+  if (cmd.kind == CMD_BASIC) Serial.print(cmd.position ? " +" : " -");
+  Serial.print(what);
+  Serial.print(number);
+  Serial.print(" Relays ");
+  Serial.println(relays.image, BIN);
+}
+
+
+void commands_class::printCommand(const AccCommand &cmd, uint8_t ch) {
+  uint8_t relay = addressMap.relay(ch);
+  Serial.print("Acc: ");
+  Serial.print(cmd.outputAddress);
+  Serial.print(cmd.position ? " +" : " -");
+  Serial.print(" Channel ");
+  Serial.print(ch + 1);
+  Serial.print(" Relay ");
+  Serial.print(relay + 1);
+  Serial.println(relays.isOn(relay) ? " on" : " off");
+}
+
+
+void commands_class::printQueueStatistics(void) {
+  // Suppressed commands are reported once per 16, to keep the log readable
+  if ((queue.highWater == reportedHighWater) && (queue.overflows == reportedOverflows) &&
+      ((suppressed >> 4) == (reportedSuppressed >> 4))) return;
+  reportedHighWater = queue.highWater;
+  reportedOverflows = queue.overflows;
+  reportedSuppressed = suppressed;
+  Serial.print("Queue: max depth ");
+  Serial.print(reportedHighWater);
+  Serial.print(", overflows ");
+  Serial.print(reportedOverflows);
+  Serial.print(", suppressed ");
+  Serial.print(suppressed);
+  Serial.print(", deactivates ");
+  Serial.println(deactivates);
+}
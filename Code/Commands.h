@@ -0,0 +1,103 @@
+// *******************************************************************************************************
+// File:      Commands.h
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//            2026/01/20 AP Version 1.1: Repeated commands are suppressed
+//            2026/01/22 AP Version 1.2: Output addresses are mapped by addressMap
+//            2026/01/26 AP Version 1.3: Routes
+//            2026/01/28 AP Version 1.4: Extended accessory (signal aspect) commands
+//            2026/01/30 AP Version 1.5: Function decoder mode
+//            2026/02/01 AP Version 1.6: Broadcast and group (bulk) commands
+//            2026/02/05 AP Version 1.7: Scripts
+//            2026/02/07 AP Version 1.8: Output modes (steady, pulse, toggle)
+//            2026/02/20 AP Version 1.9: Dedup entries expire, and are forgotten if the relay changes
+//            2026/02/21 AP Version 1.10: Group addresses that are not aligned are reported
+// 
+// Purpose:   Reception of DCC commands and their execution on the relays
+//
+// Reception and execution are decoupled by a single-producer / single-consumer ring (core_CmdQueue):
+// - receive() is the producer. It calls dcc.input() and, if an accessory command was decoded,
+//   stores output address, position, activate flag and reception time in the ring.
+//   PoM and SM messages are handled immediately, by cvProgramming.
+// - execute() is the consumer. It takes commands from the ring and applies them to the relays.
+//   Between two commands it calls receive(), so packets that arrive while relays are being
+//   switched or log lines are being printed are still taken from the DCC library in time.
+//
+// Command stations send each accessory packet several times, and often follow it by the same
+// packet with the activate flag cleared, which may be repeated as well. execute() therefore
+// remembers per channel, separately for activate and deactivate packets, the last position and
+// its time. A packet with the same (position, activate) within the window set by CV35 (DedupTime,
+// in 10ms units) is suppressed before it reaches the relays, the activity LED or the log.
+// Times are 16 bit, so an entry is cleared by a tick handler once its window has passed; otherwise
+// a packet 65,5 seconds later would match again. An entry only stands for the relay state it left
+// behind: if the relay changes through any other path (routes, aspects, bulk, functions, scripts
+// or a shortcut, see relays.changed), or if the command itself was not carried out (interlocking
+// rule, shortcut), the entry is forgotten and the next packet is executed. The end of a pulse is
+// what the command asked for: a repetition after it should not fire the coil again.
+// Deactivate packets never change a relay, and are only counted.
+// How an activate packet changes the relay depends on the output mode of the channel (steady,
+// pulse or toggle, see AddressMap.h); pulses are ended by the TCB1 ISR (Pulses.h).
+//
+// An activate command may also trigger a route (Routes.h), which sets many relays in one update.
+// Extended accessory commands select a signal aspect (Aspects.h), which also sets several relays
+// in one update.
+// In function decoder mode, loco function group packets also set up to 8 relays in one update
+// (LocoFunctions.h).
+// Accessory broadcasts and the group address switch all relays at once (Bulk.h).
+// An activate command may also start a timed script (Sequencer.h), or continue a script that
+// waits for it.
+//
+// The main sketch should call commands.init() from setup() (after decoderHardware.init()) and
+// commands.update() from loop(), as often as possible.
+//
+// ******************************************************************************************************
+#pragma once
+#include "core_Functions.h"
+#include "core_CmdQueue.h"
+#include "Relays.h"
+#include "AddressMap.h"
+#include "Routes.h"
+#include "Aspects.h"
+#include "LocoFunctions.h"
+#include "Bulk.h"
+#include "Sequencer.h"
+#include "Pulses.h"
+
+class commands_class {
+  public:
+    CmdQueue queue;
+    uint16_t suppressed;                // Repetitions within the DedupTime window
+    uint16_t deactivates;               // Deactivate packets (first of each series)
+
+    void init(void);
+    void update(void);                  // receive() + execute()
+    void receive(void);                 // Producer
+    void execute(void);                 // Consumer
+    void expire(void);                  // Called by the tick handler: clears old dedup entries
+
+  private:
+    bool printDetails;                  // Local copy of CV34
+    uint8_t reportedHighWater;          // Queue statistics are printed if they change
+    uint16_t reportedOverflows;
+    uint16_t reportedSuppressed;
+    uint16_t dedupWindow;               // In ms
+    uint8_t lastPosition[2][NUMBER_OF_RELAYS];  // [activate][channel]. 0xFF: none yet
+    uint16_t lastTime[2][NUMBER_OF_RELAYS];
+    bool registered;                    // Is the tick handler registered?
+    bool isRepetition(uint8_t channel, const AccCommand &cmd);
+    void forgetChanged(void);
+    void initAddressMap(void);
+    void executeBasic(const AccCommand &cmd);
+    bool setChannel(uint8_t channel, bool on);
+    void executeRoute(const AccCommand &cmd, uint8_t route);
+    void executeScript(const AccCommand &cmd);
+    void executeAspect(const AccCommand &cmd);
+    void executeFunctions(const AccCommand &cmd);
+    void executeBulk(const AccCommand &cmd);
+    void pushFunctions(uint8_t group, uint8_t bits);
+    void printChange(const AccCommand &cmd, const char *what, uint8_t number);
+    void printCommand(const AccCommand &cmd, uint8_t channel);
+    void printQueueStatistics(void);
+};
+
+extern commands_class commands;
@@ -2,6 +2,8 @@
 // File:      Hardware.cpp
 // Author:    Aiko Pras
 // History:   2025/12/01 AP Version 1.0
+//            2026/01/14 AP Version 1.1: Hardware PWM for LED_DCC and LED_ACC
+//            2026/01/16 AP Version 1.2: LED_DCC, LED_ACC and LED_ERROR as PatternLeds
 // 
 // Purpose:   Initialisation of the hardware
 //
@@ -27,14 +29,33 @@
 //
 // The adc_class object checks for shortcuts, using this value.
 //
+// The pwmLeds_class object replaces the software PWM of FadeOutLed (core_LEDs) for LED_DCC and
+// LED_ACC. TCA0 is used in split mode, routed to PORTF. With CLK_PER / 64 and HPER = 254 the PWM
+// frequency is 24 MHz / 64 / 255 = 1,47 kHz. Levels 0 and PWM_MAX disable the compare output and
+// drive the pin directly, since a compare value cannot give a clean 0% or 100%.
+//
 // ******************************************************************************************************
 #include <Arduino.h>
 #include "Hardware.h"
+#include "core_Tick.h"
+
+pwmLeds_class pwmLeds;
+PatternLed dccLed;
+PatternLed accLed;
+PatternLed errorLed;
+
+// Gamma (2.2) corrected compare values for the PWM_LEVELS brightness levels
+const uint8_t gammaTable[PWM_LEVELS] PROGMEM = {
+    0,   1,   1,   2,   3,   5,   7,  10,  13,  17,  21,  26,  32,  38,  44,  52,
+   60,  68,  77,  87,  97, 108, 120, 132, 145, 159, 173, 188, 204, 220, 237, 255
+};
 
 void IO_Pin_class::init() {
   init_serial();
   init_leds();
   init_relays_pins();
+  pwmLeds.init();
+  init_pattern_leds();
 }
 
 
@@ -66,6 +87,17 @@ void IO_Pin_class::init_leds() {
 }
 
 
+// Functions to switch the pattern LEDs. LED_DCC and LED_ACC use PWM, LED_ERROR is a normal pin
+void setDccLed(bool on) {pwmLeds.set(PWM_LED_DCC, on ? PWM_MAX : 0);}
+void setAccLed(bool on) {pwmLeds.set(PWM_LED_ACC, on ? PWM_MAX : 0);}
+
+void IO_Pin_class::init_pattern_leds() {
+  dccLed.attach(setDccLed);
+  accLed.attach(setAccLed);
+  errorLed.attach(FastLed<LED_ERROR_PORT, LED_ERROR_BIT>::set);
+}
+
+
 void IO_Pin_class::init_relays_pins() {
   pinMode(RELAY1, OUTPUT);
   digitalWrite(RELAY1, LOW);
@@ -146,3 +178,74 @@ bool adc_class::shortcut(uint8_t muxpos) {
   ADC0.INTFLAGS = ADC_RESRDY_bm;               // clear flag
   return (ADC0.RES > maxValue);                // set the boolean return value
 }
+
+
+// ******************************************************************************************************
+// PWM LEDs
+// ******************************************************************************************************
+void pwmLedsTick(void) {
+  pwmLeds.update();
+}
+
+
+void pwmLeds_class::init(void) {
+  // IO_Pin_class::init_leds() has already made PF4 and PF5 outputs
+  takeOverTCA0();                               // DxCore should no longer use TCA0 for analogWrite()
+  PORTMUX.TCAROUTEA = (PORTMUX.TCAROUTEA & ~PORTMUX_TCA0_gm) | PORTMUX_TCA0_PORTF_gc;
+  TCA0.SPLIT.CTRLD = TCA_SPLIT_SPLITM_bm;       // Split mode: 2 x 3 8-bit PWM channels
+  TCA0.SPLIT.HPER = 254;                        // Period for WO3..WO5
+  TCA0.SPLIT.CTRLB = 0;                         // Compare outputs enabled by write()
+  TCA0.SPLIT.CTRLA = TCA_SPLIT_CLKSEL_DIV64_gc  // 24 MHz / 64 / 255 => 1,47 kHz
+                   | TCA_SPLIT_ENABLE_bm;
+  for (uint8_t led = 0; led < PWM_LEDS; led++) set(led, 0);
+  tickScheduler.add(pwmLedsTick);
+}
+
+
+void pwmLeds_class::set(uint8_t led, uint8_t newLevel) {
+  if (newLevel > PWM_MAX) newLevel = PWM_MAX;
+  level[led] = newLevel;
+  target[led] = newLevel;
+  write(led);
+}
+
+
+void pwmLeds_class::fade(uint8_t led, uint8_t newLevel, uint8_t ticksPerStep) {
+  if (newLevel > PWM_MAX) newLevel = PWM_MAX;
+  if (ticksPerStep == 0) ticksPerStep = 1;
+  target[led] = newLevel;
+  stepTicks[led] = ticksPerStep;
+  countdown[led] = ticksPerStep;
+}
+
+
+void pwmLeds_class::update(void) {
+  for (uint8_t led = 0; led < PWM_LEDS; led++) {
+    if (level[led] == target[led]) continue;
+    if (--countdown[led]) continue;
+    countdown[led] = stepTicks[led];
+    if (level[led] < target[led]) level[led]++;
+    else level[led]--;
+    write(led);
+  }
+}
+
+
+void pwmLeds_class::write(uint8_t led) {
+  uint8_t value = pgm_read_byte(&gammaTable[level[led]]);
+  uint8_t enable = (led == PWM_LED_DCC) ? TCA_SPLIT_HCMP2EN_bm : TCA_SPLIT_HCMP1EN_bm;
+  uint8_t pinMask = (led == PWM_LED_DCC) ? PIN5_bm : PIN4_bm;
+  if (value == 0) {
+    TCA0.SPLIT.CTRLB &= ~enable;
+    PORTF.OUTCLR = pinMask;
+  }
+  else if (value == 255) {
+    TCA0.SPLIT.CTRLB &= ~enable;
+    PORTF.OUTSET = pinMask;
+  }
+  else {
+    if (led == PWM_LED_DCC) TCA0.SPLIT.HCMP2 = value;
+    else TCA0.SPLIT.HCMP1 = value;
+    TCA0.SPLIT.CTRLB |= enable;
+  }
+}
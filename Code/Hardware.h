@@ -2,16 +2,22 @@
 // File:      Hardware.h
 // Author:    Aiko Pras
 // History:   2025/12/01 AP Version 1.0
+//            2026/01/14 AP Version 1.1: Hardware PWM for LED_DCC and LED_ACC
+//            2026/01/16 AP Version 1.2: LED_DCC, LED_ACC and LED_ERROR as PatternLeds
 // 
 // Purpose:   Pin definitions for the TMC 16-Channel AVR32DA48 Switch Decoder board
-//            Header file for the hardware initialisation and the ADC functions
+//            Header file for the hardware initialisation, the ADC and the PWM LED functions
 //
 // The following Timers are used:
+// TCA0: PWM for LED_DCC and LED_ACC (split mode, routed to PORTF)
 // TCB0: AP_DCC_LIB
+// TCB1: Tick scheduler (core_Tick) and end of relay pulses (Pulses.h)
 // TCB2: DxCore default for millis()
+// TCB3: Clock of the benchmark suite (Benchmark.h), only if TMC_BENCHMARK is defined
 //
 // ******************************************************************************************************
 #pragma once
+#include "core_LEDs.h"
 
 // DCC pins
 #define dccPin            PIN_PA1    // DCC input pin
@@ -26,6 +32,19 @@
 // Button pin
 #define buttonPin         PIN_PF6    // The onboard button to set the DCC address
 
+// Port and bit of the LED and button pins above, for the compile-time templates FastLed
+// (core_LEDs.h) and FastButton (core_ProgButton.h). These must match the pin definitions above.
+#define LED_DCC_PORT      PF
+#define LED_DCC_BIT       5
+#define LED_ACC_PORT      PF
+#define LED_ACC_BIT       4
+#define LED_PROG_PORT     PA
+#define LED_PROG_BIT      0
+#define LED_ERROR_PORT    PA
+#define LED_ERROR_BIT     3
+#define buttonPort        PF
+#define buttonBit         6
+
 // Monitoring Pins
 #define MON_TXD           PIN_PA4    // Serial
 #define MON_RXD           PIN_PA5    // 
@@ -77,6 +96,7 @@ class IO_Pin_class {
   private:
     void init_serial();
     void init_leds();
+    void init_pattern_leds();
     void init_relays_pins();
 };
 
@@ -90,3 +110,49 @@ class adc_class {
     void init_adc_pins();
     void init_adc_logic();
 };
+
+
+// ******************************************************************************************************
+// PWM for LED_DCC and LED_ACC
+// LED_DCC (PF5) and LED_ACC (PF4) are driven by TCA0 in split mode: PF5 = WO5 (HCMP2) and
+// PF4 = WO4 (HCMP1). Brightness has PWM_LEVELS levels; a gamma table in flash maps each level
+// to a compare value, such that equal steps look equally large to the eye.
+// Fading is done by the tick handler, one level every `stepTicks` ticks. Both LEDs can fade
+// at the same time. Examples:
+//   pwmLeds.fade(PWM_LED_ACC, 0, 5);     // fade out in 31 * 5 ticks (1,55 sec)
+//   pwmLeds.set(PWM_LED_DCC, PWM_MAX);   // immediately fully on
+#define PWM_LED_DCC      0
+#define PWM_LED_ACC      1
+#define PWM_LEDS         2
+#define PWM_LEVELS      32                // Brightness levels 0..31
+#define PWM_MAX         (PWM_LEVELS - 1)
+
+class pwmLeds_class {
+  public:
+    void init(void);
+    void set(uint8_t led, uint8_t level);                     // Immediately, stops a fade
+    void fade(uint8_t led, uint8_t level, uint8_t stepTicks); // One level per stepTicks ticks
+    void turn_on(uint8_t led) {set(led, PWM_MAX);}
+    void turn_off(uint8_t led) {set(led, 0);}
+    bool ledIsOn(uint8_t led) {return (level[led] != 0);}
+    bool fading(uint8_t led) {return (level[led] != target[led]);}
+    void update(void);                                        // Called by the tick scheduler
+  private:
+    uint8_t level[PWM_LEDS];                                  // Current brightness level
+    uint8_t target[PWM_LEDS];                                 // Brightness level to fade to
+    uint8_t stepTicks[PWM_LEDS];                              // Ticks per fade step
+    uint8_t countdown[PWM_LEDS];                              // Ticks till the next fade step
+    void write(uint8_t led);
+};
+
+extern pwmLeds_class pwmLeds;
+
+
+// ******************************************************************************************************
+// The indicator LEDs, as played by the LedPatterns engine (core_LEDs). Attached by IO_Pin_class::init()
+// The programming LED (LED_PROG) is attached by core_Functions.
+// LED_DCC and LED_ACC are switched via pwmLeds, so a pattern overrides a running fade and vice versa.
+// errorLed.blinkCode(channel) shows the number of a faulting channel.
+extern PatternLed dccLed;
+extern PatternLed accLed;
+extern PatternLed errorLed;
@@ -0,0 +1,32 @@
+// *******************************************************************************************************
+// File:      Interlock.cpp
+// Author:    Aiko Pras
+// History:   2026/02/03 AP Version 1.0
+// 
+// Purpose:   Interlocking rules: relay combinations that may never occur
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Interlock.h"
+#include "core_Functions.h"
+
+interlock_class interlock;
+
+
+void interlock_class::init(void) {
+  for (uint8_t rule = 0; rule < MAX_RULES; rule++) {
+    uint16_t cv = InterlockTable + rule * RULE_SIZE;
+    mask[rule] = (cvValues.read(cv + 1) << 8) | cvValues.read(cv);
+    forbidden[rule] = (cvValues.read(cv + 3) << 8) | cvValues.read(cv + 2);
+    if ((mask[rule] == 0) || (mask[rule] == 0xFFFF)) {
+      mask[rule] = 0;
+      forbidden[rule] = 0xFFFF;
+    }
+    else forbidden[rule] &= mask[rule];
+  }
+}
+
+
+bool interlock_class::affectedBy(uint16_t cvNumber) {
+  return ((cvNumber >= InterlockTable) && (cvNumber < InterlockTable + MAX_RULES * RULE_SIZE));
+}
@@ -0,0 +1,48 @@
+// *******************************************************************************************************
+// File:      Interlock.h
+// Author:    Aiko Pras
+// History:   2026/02/03 AP Version 1.0
+// 
+// Purpose:   Interlocking rules: relay combinations that may never occur
+//
+// Some relay combinations are dangerous, such as two relays that feed the same frog with opposite
+// polarity. An interlock table in EEPROM (CV256..287) holds up to MAX_RULES rules of 4 bytes each:
+//   byte 0, 1:   relay mask (low = relay 1..8, high = relay 9..16). 0 or 0xFFFF: rule not used
+//   byte 2, 3:   forbidden pattern (low, high)
+// A relay image violates a rule if (image & mask) == forbidden. For example, mask 0x0003 with
+// forbidden 0x0003 means that relay 1 and 2 may never be energised at the same time.
+//
+// Every change of the relay image (relays.apply()) is checked against all rules, before it is
+// written. A change that violates a rule is rejected as a whole, and counted. Unused rules are
+// stored as mask 0 with forbidden 0xFFFF, which never matches. check() therefore always
+// evaluates all rules, with an AND and a compare each, and its time does not depend on the table.
+//
+// init() should be called again after a CV in the table has been changed (see affectedBy()).
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+#define MAX_RULES         8
+#define RULE_SIZE         4
+
+class interlock_class {
+  public:
+    uint16_t rejected;                        // Number of rejected changes since start
+
+    void init(void);
+    bool affectedBy(uint16_t cvNumber);
+    // Returns the rules violated by this image: bit n = rule n+1. 0: image is allowed
+    uint8_t check(uint16_t image) {
+      uint8_t violated = 0;
+      for (uint8_t rule = 0; rule < MAX_RULES; rule++)
+        if ((image & mask[rule]) == forbidden[rule]) violated |= (1 << rule);
+      return violated;
+    }
+
+  private:
+    uint16_t mask[MAX_RULES];
+    uint16_t forbidden[MAX_RULES];
+};
+
+extern interlock_class interlock;
@@ -0,0 +1,74 @@
+// *******************************************************************************************************
+// File:      LocoFunctions.cpp
+// Author:    Aiko Pras
+// History:   2026/01/30 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Output modes (pulse, toggle)
+// 
+// Purpose:   Function decoder mode: loco function packets drive the relays
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "LocoFunctions.h"
+#include "AddressMap.h"
+#include "Relays.h"
+#include "Pulses.h"
+#include "core_Functions.h"
+
+locoFunctions_class locoFunctions;
+
+// Lowest function and number of functions for each function group
+const uint8_t groupFirst[5] PROGMEM = {0, 5, 9, 13, 21};
+const uint8_t groupSize[5]  PROGMEM = {5, 4, 4, 8, 8};
+
+
+void locoFunctions_class::init(void) {
+  address = (cvValues.read(FuncAddrH) << 8) | cvValues.read(FuncAddrL);
+  if (address > 10239) address = 0;           // Highest long loco address
+  state = 0;
+  initMapping();
+}
+
+
+void locoFunctions_class::initMapping(void) {
+  first = cvValues.read(FuncFirst);
+}
+
+
+bool locoFunctions_class::affectedBy(uint16_t cvNumber) {
+  return (cvNumber == FuncFirst);
+}
+
+
+void locoFunctions_class::apply(uint8_t group, uint8_t bits) {
+  // Walk over the functions of this group, and collect the relays of the steady channels they
+  // drive, and the channels whose function changed
+  uint8_t function = pgm_read_byte(&groupFirst[group]);
+  uint8_t size = pgm_read_byte(&groupSize[group]);
+  uint16_t mask = 0;
+  uint16_t value = 0;
+  uint16_t edges = 0;
+  for (uint8_t i = 0; i < size; i++, function++, bits >>= 1) {
+    uint8_t ch = function - first;            // Wraps for functions below `first`
+    if (ch >= NUMBER_OF_RELAYS) continue;
+    uint16_t chBit = (uint16_t)1 << ch;
+    bool on = (bits & 1) ^ addressMap.inverted(ch);
+    if (on != (bool)(state & chBit)) edges |= chBit;
+    state = on ? (state | chBit) : (state & ~chBit);
+    if (addressMap.mode(ch) != MODE_STEADY) continue;
+    uint16_t relayBit = (uint16_t)1 << addressMap.relay(ch);
+    mask |= relayBit;
+    if (on) value |= relayBit;
+  }
+  if (mask) relays.apply(mask, value);
+  // Pulse and toggle channels act on a change only, as an accessory command would
+  for (uint8_t ch = 0; edges; ch++, edges >>= 1) {
+    if (!(edges & 1)) continue;
+    uint8_t relay = addressMap.relay(ch);
+    bool on = (state >> ch) & 1;
+    if (addressMap.mode(ch) == MODE_PULSE) {
+      if (on) pulses.start(relay);
+      else pulses.stop(relay);
+    }
+    else if ((addressMap.mode(ch) == MODE_TOGGLE) && on) relays.set(relay, !relays.isOn(relay));
+  }
+}
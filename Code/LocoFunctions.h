@@ -0,0 +1,59 @@
+// *******************************************************************************************************
+// File:      LocoFunctions.h
+// Author:    Aiko Pras
+// History:   2026/01/30 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Output modes (pulse, toggle)
+// 
+// Purpose:   Function decoder mode: loco function packets drive the relays
+//
+// Besides accessory packets, the decoder may listen to the function group packets of a loco
+// address (CV64/65, low and high byte). Throttles and apps that only speak loco functions can then
+// switch the relays, and a single packet switches up to 8 relays at once.
+// If CV64/65 is 0 (the default) this mode is off.
+//
+// Function F(n) drives channel n - CV66 + 1. With CV66 = 1 (the default) F1..F16 drive channel
+// 1..16; with CV66 = 13, for example, F13..F28 drive channel 1..16. Functions outside this range
+// are ignored. Channels are mapped to relays, may be inverted, and have an output mode, in the
+// same way as for accessory commands (see AddressMap.h).
+//
+// Each function group packet (F0-F4, F5-F8, F9-F12, F13-F20, F21-F28) carries the state of all
+// functions in its group. These are translated to a relay mask and value, which are applied by a
+// single relays.apply(), thus with one write per port. Command stations repeat function packets
+// continuously; since an unchanged image is not written, these repetitions cost nearly nothing.
+// This holds for steady channels. A channel in pulse or toggle mode should not fire again on each
+// repetition; it only acts when its function changes (`state`), as an accessory command with the
+// new function state as position: on starts a pulse or changes the relay, off ends the pulse.
+//
+// AP_DCC_library has a single loco address (locoCmd.setMyAddress()), which is normally used for
+// PoM (see CvProgramming::initPoM()). In function decoder mode it is set to the function address
+// instead, so PoM messages should then be sent to the function address. Since this address
+// should not change in the middle of PoM programming, a new CV64/65 value takes effect after a
+// restart. A new CV66 value takes effect immediately (see affectedBy()).
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+// Function groups, as they are stored in AccCommand.position
+#define FG_F0_F4          0
+#define FG_F5_F8          1
+#define FG_F9_F12         2
+#define FG_F13_F20        3
+#define FG_F21_F28        4
+
+class locoFunctions_class {
+  public:
+    uint16_t address;                         // Loco address. 0: function decoder mode is off
+
+    void init(void);                          // Reads the CVs
+    void initMapping(void);                   // Reads CV66 only
+    bool affectedBy(uint16_t cvNumber);       // Should initMapping() be called after this CV has changed?
+    // bits: function states of the group, with bit 0 = lowest function of the group
+    void apply(uint8_t group, uint8_t bits);
+
+  private:
+    uint8_t first;                            // Function that drives channel 1 (CV66)
+    uint16_t state;                           // Last function state per channel (after inversion)
+};
+
+extern locoFunctions_class locoFunctions;
@@ -5,6 +5,7 @@
 // History:   2024/04/27 AP V1.0
 //            2025/12/01 AP V1.1: Changed, to be used with the TMC Switch-16 decoder.
 //                                Filename capitalized, to show-up first in the IDE
+//            2026/02/15 AP V1.2: TMC_BENCHMARK
 //
 // Purpose:   Each switch-decoder gets a unique default DCC addresses.
 //            Although this address may be changed using normal procedure (programming button, 
@@ -36,6 +37,10 @@
 
 #define DECODER 1
 
+// Uncomment to include the benchmark suite (Benchmark.h). The sketch should then call
+// benchmark.run() at the end of setup(); the results are sent over Serial
+// #define TMC_BENCHMARK
+
 //******************************************************************************************************
 // Do not edit below this line
 // CV1: Decoder address, low order bits (1..64)
@@ -0,0 +1,90 @@
+// *******************************************************************************************************
+// File:      Pulses.cpp
+// Author:    Aiko Pras
+// History:   2026/02/07 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Other writes that change a relay cancel its pulse
+// 
+// Purpose:   Relay pulses of a defined length, for channels in pulse mode
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Pulses.h"
+#include "Relays.h"
+#include "core_Functions.h"
+#include "core_Tick.h"
+
+pulses_class pulses;
+
+
+void pulsesIsr(uint16_t now) {
+  pulses.isr(now);
+}
+
+
+void pulses_class::init(void) {
+  uint8_t cv = cvValues.read(PulseTime);
+  if (cv == 0) cv = 1;
+  length = cv * 10;                 // Running pulses keep their length
+}
+
+
+void pulses_class::start(uint8_t relay) {
+  uint16_t bit = (uint16_t)1 << relay;
+  uint8_t oldSREG = SREG;
+  cli();
+  cancel(bit);                      // From here on the ISR can't release the relay
+  SREG = oldSREG;
+  if (!(relays.apply(bit, bit) & bit)) return;          // Rejected by an interlocking rule or shortcut
+  cli();
+  uint16_t now = tickScheduler.ms();
+  endMs[relay] = now + length;
+  running |= bit;
+  arm(now);
+  SREG = oldSREG;
+}
+
+
+void pulses_class::stop(uint8_t relay) {
+  uint16_t bit = (uint16_t)1 << relay;
+  relays.apply(bit, 0);             // Cancels the pulse as well
+}
+
+
+void pulses_class::cancel(uint16_t mask) {
+  running &= ~mask;                 // The compare may stay armed; the ISR then finds nothing
+}
+
+
+void pulses_class::arm(uint16_t now) {
+  // Find the first pulse to end. Times wrap, so compare the time left
+  uint16_t first = 0;
+  uint16_t left = 0xFFFF;
+  for (uint8_t relay = 0; relay < 16; relay++) {
+    if (!((running >> relay) & 1)) continue;
+    uint16_t relayLeft = endMs[relay] - now;
+    if (relayLeft < left) {
+      left = relayLeft;
+      first = endMs[relay];
+    }
+  }
+  if (running) tickScheduler.compare(first, pulsesIsr);
+}
+
+
+void pulses_class::isr(uint16_t now) {
+  uint16_t ended = 0;
+  for (uint8_t relay = 0; relay < 16; relay++) {
+    if (!((running >> relay) & 1)) continue;
+    if ((int16_t)(endMs[relay] - now) <= 0) ended |= ((uint16_t)1 << relay);
+  }
+  if (ended) {
+    // One OUTCLR per port, for all pulses that end now
+    uint8_t bits;
+    if ((bits = relays.portA(ended))) PORTA.OUTCLR = bits;
+    if ((bits = relays.portB(ended))) PORTB.OUTCLR = bits;
+    if ((bits = relays.portC(ended))) PORTC.OUTCLR = bits;
+    running &= ~ended;
+    relays.releasedByIsr |= ended;
+  }
+  arm(now);
+}
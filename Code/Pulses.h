@@ -0,0 +1,48 @@
+// *******************************************************************************************************
+// File:      Pulses.h
+// Author:    Aiko Pras
+// History:   2026/02/07 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Other writes that change a relay cancel its pulse
+// 
+// Purpose:   Relay pulses of a defined length, for channels in pulse mode
+//
+// Solenoid turnouts and uncouplers that are wired through the relays need a pulse of a defined
+// length (typically 50..500 ms). If the end of such a pulse were polled from the main loop, its
+// length would depend on how busy the loop is; a long pulse may even burn the coil.
+//
+// start() energises the relay via relays.apply(), and schedules its release after CV75 x 10ms.
+// The release is done by the TCB1 ISR (tickScheduler.compare()), with a resolution of 1 ms and
+// independent of the main loop. The compare is armed for the first pulse to end only. The ISR
+// releases all relays whose pulse has ended with a single OUTCLR write per port, and re-arms the
+// compare for the next pulse. The relays are marked in relays.releasedByIsr, so the relay image
+// is updated on the next relays.apply().
+//
+// A relay that something else switches off while its pulse runs (route, aspect, bulk, function,
+// script, a steady channel) should keep what was written. relays.apply() therefore cancels the
+// pulses of the relays that change, once the new image has passed the interlocking rules. A write
+// that leaves a pulsing relay energised changes nothing, so the pulse still ends in time.
+// start() cancels the previous pulse of the relay itself, before its relays.apply(); the ISR can
+// then no longer release the relay in between. If the ISR released it just before, apply() takes
+// that over, and energises the relay again.
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+class pulses_class {
+  public:
+    void init(void);                          // Reads CV75
+    void start(uint8_t relay);                // relay: 0..15
+    void stop(uint8_t relay);                 // Ends the pulse now
+    bool active(uint8_t relay) {return (running >> relay) & 1;}
+    void cancel(uint16_t mask);               // Interrupts should be disabled
+    void isr(uint16_t now);                   // Called within the TCB1 ISR
+
+  private:
+    uint16_t length;                          // Pulse length in ms
+    uint16_t endMs[16];                       // Per relay: time the pulse ends
+    volatile uint16_t running;                // Relays with a pulse that did not yet end
+    void arm(uint16_t now);                   // Interrupts should be disabled
+};
+
+extern pulses_class pulses;
@@ -0,0 +1,159 @@
+// *******************************************************************************************************
+// File:      Relays.cpp
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//            2026/02/03 AP Version 1.1: Interlocking rules
+//            2026/02/07 AP Version 1.2: Relays may be released by an ISR (pulses)
+//            2026/02/20 AP Version 1.3: changed; writes cancel pulses of the relays they change;
+//                                       releaseAll()
+// 
+// Purpose:   Relay output layer for the 16 relays of the TMC switch decoder
+//
+// The mapping of relays to port pins (Hardware.h) was chosen to simplify the PCB:
+//   RELAY1..6   => PB5..PB0   (reversed)
+//   RELAY7..8   => PA7, PA6   (swapped)
+//   RELAY9..12  => PC4..PC7
+//   RELAY13..16 => PC3..PC0   (reversed)
+// portA() .. portC() translate relay bits into port bits with a few shifts and a 16 byte table
+// that reverses 4 bits, instead of 16 calls to digitalWrite().
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Relays.h"
+#include "Pulses.h"
+
+relays_class relays;
+
+// Reverses the order of the 4 lowest bits
+const uint8_t reverse4[16] PROGMEM = {
+  0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
+// ADC input per relay
+const uint8_t adcRelay[NUMBER_OF_RELAYS] PROGMEM = {
+  ADC_RELAY1,  ADC_RELAY2,  ADC_RELAY3,  ADC_RELAY4,  ADC_RELAY5,  ADC_RELAY6,  ADC_RELAY7,  ADC_RELAY8,
+  ADC_RELAY9,  ADC_RELAY10, ADC_RELAY11, ADC_RELAY12, ADC_RELAY13, ADC_RELAY14, ADC_RELAY15, ADC_RELAY16
+};
+
+
+void relays_class::init(uint8_t shortcutValue, bool print) {
+  // The relay pins are already made output (and LOW) by IO_Pin_class::init()
+  adc.init(shortcutValue);
+  printDetails = print;
+  image = 0;
+  shortcuts = 0;
+  shortcutCount = 0;
+  releasedByIsr = 0;
+  changed = 0;
+  interlock.init();
+}
+
+
+uint16_t relays_class::apply(uint16_t mask, uint16_t value) {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (releasedByIsr) {
+    image &= ~releasedByIsr;                      // Not in changed: the pulse ended as commanded
+    releasedByIsr = 0;
+  }
+  SREG = oldSREG;
+  uint16_t newImage = (image & ~mask) | (value & mask);
+  uint16_t energised = newImage & ~image;
+  if (newImage == image) return image;
+  uint8_t violated = interlock.check(newImage);
+  if (violated) {
+    interlock.rejected++;
+    if (printDetails) {
+      Serial.print("Interlock: rejected ");
+      Serial.print(newImage, BIN);
+      Serial.print(" Rules ");
+      Serial.println(violated, BIN);
+    }
+    return image;
+  }
+  // The pulses of relays that change end here; a relay that keeps its state keeps its pulse
+  cli();
+  pulses.cancel(newImage ^ image);
+  SREG = oldSREG;
+  write(newImage);
+  if (energised) {
+    uint16_t failed = checkShortcuts(energised);
+    if (failed) write(image & ~failed);           // Releasing is always safer than a shortcut
+  }
+  return image;
+}
+
+
+void relays_class::releaseAll(void) {
+  uint8_t oldSREG = SREG;
+  cli();
+  pulses.cancel(0xFFFF);
+  image &= ~releasedByIsr;
+  releasedByIsr = 0;
+  SREG = oldSREG;
+  write(0);
+}
+
+
+void relays_class::set(uint8_t relay, bool on) {
+  uint16_t mask = (uint16_t)1 << relay;
+  apply(mask, on ? mask : 0);
+}
+
+
+uint8_t relays_class::portA(uint16_t bits) {
+  return ((bits << 1) & 0x80) | ((bits >> 1) & 0x40);
+}
+
+
+uint8_t relays_class::portB(uint16_t bits) {
+  return (pgm_read_byte(&reverse4[bits & 0x0F]) << 2) | (pgm_read_byte(&reverse4[(bits >> 4) & 0x03]) >> 2);
+}
+
+
+uint8_t relays_class::portC(uint16_t bits) {
+  return ((bits >> 4) & 0xF0) | pgm_read_byte(&reverse4[bits >> 12]);
+}
+
+
+void relays_class::write(uint16_t newImage) {
+  // Only pins that change are written. A pin that an ISR has released, but that is still set in
+  // image, is therefore not energised again
+  uint16_t on = newImage & ~image;
+  uint16_t off = image & ~newImage;
+  changed |= on | off;
+  if ((on | off) & 0x00C0) {
+    PORTA.OUTSET = portA(on);
+    PORTA.OUTCLR = portA(off);
+  }
+  if ((on | off) & 0x003F) {
+    PORTB.OUTSET = portB(on);
+    PORTB.OUTCLR = portB(off);
+  }
+  if ((on | off) & 0xFF00) {
+    PORTC.OUTSET = portC(on);
+    PORTC.OUTCLR = portC(off);
+  }
+  image = newImage;
+}
+
+
+uint16_t relays_class::checkShortcuts(uint16_t energised) {
+  // Measure the current through each relay that has just been switched on. A relay coil
+  // draws hardly any current during the first milliseconds, a shortcut does immediately.
+  uint16_t failed = 0;
+  for (uint8_t relay = 0; relay < NUMBER_OF_RELAYS; relay++) {
+    if (!(energised & ((uint16_t)1 << relay))) continue;
+    if (adc.shortcut(pgm_read_byte(&adcRelay[relay]))) {
+      failed |= ((uint16_t)1 << relay);
+      shortcutCount++;
+      errorLed.blinkCode(relay + 1);
+      if (printDetails) {
+        Serial.print("Shortcut on channel ");
+        Serial.println(relay + 1);
+      }
+    }
+  }
+  shortcuts |= failed;
+  return failed;
+}
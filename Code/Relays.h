@@ -0,0 +1,68 @@
+// *******************************************************************************************************
+// File:      Relays.h
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//            2026/02/03 AP Version 1.1: Interlocking rules
+//            2026/02/07 AP Version 1.2: Relays may be released by an ISR (pulses)
+//            2026/02/20 AP Version 1.3: changed; writes cancel pulses of the relays they change;
+//                                       releaseAll()
+// 
+// Purpose:   Relay output layer for the 16 relays of the TMC switch decoder
+//
+// The state of all relays is kept in a 16 bit image: bit 0 = RELAY1 ... bit 15 = RELAY16.
+// apply(mask, value) sets all relays selected by `mask` to the corresponding bits of `value`, in
+// a single update. The image is mapped onto PORTA, PORTB and PORTC (see Hardware.h); each port
+// gets at most one OUTSET and one OUTCLR write, for the pins that change only. These writes are
+// atomic, so ISRs that change other pins of the same port are never disturbed.
+//
+// An ISR may release relays itself (see Pulses.h), using portA() .. portC() and OUTCLR. It should
+// then add these relays to `releasedByIsr`; apply() removes them from the image before it
+// determines which pins change. Once the new image has been accepted, apply() cancels the pulses
+// of the relays that change, so that the ISR does not release what was just written; a relay that
+// keeps its state also keeps its pulse (see Pulses.h).
+// Each relay that apply() writes is also added to `changed`. Commands uses it to forget repeated
+// commands for a relay that was changed by another path, and clears it (Commands.h). The end of a
+// pulse is not a change in this sense, and is not added.
+// A new image that violates an interlocking rule (Interlock.h) is not written; apply() then
+// returns the unchanged image. releaseAll() is the exception: an emergency all off releases every
+// relay and ends all pulses, without the check, so that no rule can keep a relay energised.
+//
+// After relays have been energised, the current through each of them is measured by the ADC
+// (adc_class). A relay that shows a shortcut is switched off again; its channel number is
+// shown on LED_ERROR.
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "Hardware.h"
+#include "Interlock.h"
+
+#define NUMBER_OF_RELAYS  16
+
+class relays_class {
+  public:
+    adc_class adc;                                  // For the shortcut check
+    uint16_t image;                                 // Current state: bit n = relay n+1 energised
+    uint16_t shortcuts;                             // Relays switched off due to a shortcut
+    uint16_t shortcutCount;                         // Number of shortcuts since start
+    volatile uint16_t releasedByIsr;                // Released by an ISR, but still in image
+    uint16_t changed;                               // Relays that changed, until cleared by commands
+    bool printDetails;                              // Local copy of CV34
+
+    void init(uint8_t shortcutValue, bool print);
+    uint16_t apply(uint16_t mask, uint16_t value);  // Returns the new image
+    void releaseAll(void);                          // No interlocking check
+    void set(uint8_t relay, bool on);               // relay: 0..15
+    bool isOn(uint8_t relay) {return (image >> relay) & 1;}
+
+    // Relay bits (as in image) to port bits
+    uint8_t portA(uint16_t bits);
+    uint8_t portB(uint16_t bits);
+    uint8_t portC(uint16_t bits);
+
+  private:
+    void write(uint16_t newImage);
+    uint16_t checkShortcuts(uint16_t energised);
+};
+
+extern relays_class relays;
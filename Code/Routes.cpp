@@ -0,0 +1,46 @@
+// *******************************************************************************************************
+// File:      Routes.cpp
+// Author:    Aiko Pras
+// History:   2026/01/26 AP Version 1.0
+// 
+// Purpose:   Routes: a single accessory command switches many relays at once
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Routes.h"
+#include "Relays.h"
+#include "core_Functions.h"
+
+routes_class routes;
+
+
+void routes_class::init(void) {
+  uint16_t keys[MAX_ROUTES];
+  uint8_t values[MAX_ROUTES];
+  number = 0;
+  for (uint8_t route = 0; route < MAX_ROUTES; route++) {
+    uint16_t cv = RouteTable + route * ROUTE_SIZE;
+    uint8_t high = cvValues.read(cv + 1);
+    uint16_t address = ((high & 0x0F) << 8) | cvValues.read(cv);
+    uint8_t position = (high >> 7);
+    mask[route] = (cvValues.read(cv + 3) << 8) | cvValues.read(cv + 2);
+    value[route] = (cvValues.read(cv + 5) << 8) | cvValues.read(cv + 4);
+    if ((address == 0) || (address > 2048)) keys[route] = HASH_EMPTY;
+    else {
+      keys[route] = (address << 1) | position;
+      number++;
+    }
+    values[route] = route;
+  }
+  triggers.build(keys, values, MAX_ROUTES);
+}
+
+
+bool routes_class::affectedBy(uint16_t cvNumber) {
+  return ((cvNumber >= RouteTable) && (cvNumber < RouteTable + MAX_ROUTES * ROUTE_SIZE));
+}
+
+
+void routes_class::apply(uint8_t route) {
+  relays.apply(mask[route], value[route]);
+}
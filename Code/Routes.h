@@ -0,0 +1,47 @@
+// *******************************************************************************************************
+// File:      Routes.h
+// Author:    Aiko Pras
+// History:   2026/01/26 AP Version 1.0
+// 
+// Purpose:   Routes: a single accessory command switches many relays at once
+//
+// A route table in EEPROM (CV128..175) holds up to MAX_ROUTES routes of 6 bytes each:
+//   byte 0: trigger output address, low byte
+//   byte 1: bit 0..3: trigger output address, high bits; bit 7: trigger position (0 = -, 1 = +)
+//   byte 2: relay mask, low byte (relay 1..8)      byte 3: relay mask, high byte (relay 9..16)
+//   byte 4: relay value, low byte                  byte 5: relay value, high byte
+// A route with trigger address 0 or above 2048 (such as erased EEPROM) is not used.
+// When an activate command for (address, position) is received, the relays in the mask are set
+// to the corresponding bits of value, as a single update of the relay image (relays.apply()).
+// The trigger address may be any output address, also one that is not used by a channel.
+//
+// init() reads the table once, and builds a perfect hash (core_PerfectHash) from trigger to
+// route. lookup() is therefore constant-time. init() should be called again after a CV in the
+// route table has been changed (see affectedBy()).
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "core_PerfectHash.h"
+
+#define MAX_ROUTES        8
+#define ROUTE_SIZE        6
+#define NO_ROUTE          HASH_NOT_FOUND
+
+class routes_class {
+  public:
+    void init(void);
+    bool affectedBy(uint16_t cvNumber);
+    uint8_t lookup(uint16_t outputAddress, uint8_t position) {
+      return triggers.lookup((outputAddress << 1) | position);
+    }
+    void apply(uint8_t route);                // Sets the relays of this route
+    uint8_t number;                           // Number of routes in use
+
+  private:
+    PerfectHash<4> triggers;                  // (address << 1 | position) => route
+    uint16_t mask[MAX_ROUTES];
+    uint16_t value[MAX_ROUTES];
+};
+
+extern routes_class routes;
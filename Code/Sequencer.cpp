@@ -0,0 +1,122 @@
+// *******************************************************************************************************
+// File:      Sequencer.cpp
+// Author:    Aiko Pras
+// History:   2026/02/05 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Triggers are ignored for DedupTime after a start; stopAll()
+// 
+// Purpose:   Timed relay scripts, stored in EEPROM as bytecode and triggered by accessory commands
+//
+// ******************************************************************************************************
+#include <Arduino.h>
+#include "Sequencer.h"
+#include "Relays.h"
+#include "core_Functions.h"
+#include "core_Tick.h"
+
+sequencer_class sequencer;
+
+
+void sequencerTick(void) {
+  sequencer.update();
+}
+
+
+// Trigger and WAITIN address: low byte, then high bits plus position in bit 7
+static uint16_t triggerKey(uint8_t low, uint8_t high) {
+  uint16_t address = ((high & 0x0F) << 8) | low;
+  if ((address == 0) || (address > 2048)) return HASH_EMPTY;
+  return (address << 1) | (high >> 7);
+}
+
+
+void sequencer_class::init(void) {
+  uint16_t keys[MAX_SCRIPTS];
+  uint8_t values[MAX_SCRIPTS];
+  holdOffTicks = cvValues.read(DedupTime) * 10 / TICK_MS;
+  for (uint8_t script = 0; script < MAX_SCRIPTS; script++) {
+    uint16_t cv = ScriptTable + script * SCRIPT_TRIGGER;
+    keys[script] = triggerKey(cvValues.read(cv), cvValues.read(cv + 1));
+    values[script] = script;
+    startPc[script] = cvValues.read(cv + 2);
+    state[script] = IDLE;
+    holdOff[script] = 0;
+  }
+  triggers.build(keys, values, MAX_SCRIPTS);
+  if (!registered) registered = tickScheduler.add(sequencerTick);
+}
+
+
+bool sequencer_class::affectedBy(uint16_t cvNumber) {
+  // Changing the code area stops all scripts as well, since they may now run into garbage
+  return (cvNumber >= ScriptTable);
+}
+
+
+void sequencer_class::start(uint8_t script) {
+  pc[script] = startPc[script];
+  state[script] = RUN;
+  holdOff[script] = holdOffTicks;
+}
+
+
+void sequencer_class::stopAll(void) {
+  for (uint8_t script = 0; script < MAX_SCRIPTS; script++) state[script] = IDLE;
+}
+
+
+void sequencer_class::input(uint16_t outputAddress, uint8_t position) {
+  uint16_t key = (outputAddress << 1) | position;
+  for (uint8_t script = 0; script < MAX_SCRIPTS; script++)
+    if ((state[script] == WAITIN) && (waitKey[script] == key)) state[script] = RUN;
+}
+
+
+void sequencer_class::update(void) {
+  for (uint8_t script = 0; script < MAX_SCRIPTS; script++) {
+    if (holdOff[script]) holdOff[script]--;
+    if ((state[script] == WAIT) && (--wait[script] == 0)) state[script] = RUN;
+    for (uint8_t i = 0; (i < SEQ_BUDGET) && (state[script] == RUN); i++) step(script);
+  }
+}
+
+
+uint8_t sequencer_class::fetch(uint8_t script) {
+  uint16_t cv = ScriptCode + pc[script]++;
+  if (cv > E2END) return SEQ_END;
+  return cvValues.read(cv);
+}
+
+
+void sequencer_class::step(uint8_t script) {
+  uint8_t opcode = fetch(script);
+  switch (opcode) {
+    case SEQ_SET:
+    case SEQ_CLR: {
+      uint16_t mask = fetch(script);
+      mask |= fetch(script) << 8;
+      relays.apply(mask, (opcode == SEQ_SET) ? mask : 0);
+    }
+    break;
+    case SEQ_WAIT:
+      wait[script] = fetch(script);
+      if (wait[script]) state[script] = WAIT;
+    break;
+    case SEQ_JMP:
+      pc[script] = fetch(script);
+    break;
+    case SEQ_WAITIN: {
+      uint8_t low = fetch(script);
+      waitKey[script] = triggerKey(low, fetch(script));
+      state[script] = WAITIN;
+    }
+    break;
+    case SEQ_END:
+    case 0xFF:
+      state[script] = IDLE;
+    break;
+    default:
+      badOpcodes++;
+      state[script] = IDLE;
+    break;
+  }
+}
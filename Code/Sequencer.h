@@ -0,0 +1,87 @@
+// *******************************************************************************************************
+// File:      Sequencer.h
+// Author:    Aiko Pras
+// History:   2026/02/05 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Triggers are ignored for DedupTime after a start; stopAll()
+// 
+// Purpose:   Timed relay scripts, stored in EEPROM as bytecode and triggered by accessory commands
+//
+// Level crossings, uncoupler pulses, fall-back of signals etc. need relays that are switched in a
+// timed order. Instead of sending a packet for every step, such a sequence can be stored in EEPROM
+// as a script, and started by a single accessory command.
+//
+// The script table (CV288..299) holds MAX_SCRIPTS triggers of 3 bytes each:
+//   byte 0:      trigger output address, low byte
+//   byte 1:      bit 0..3: trigger output address, high bits; bit 7: trigger position (0 = -, 1 = +)
+//   byte 2:      start of the script, as offset within the code area
+// A trigger with address 0 or above 2048 is not used.
+// The code area (CV300 .. end of EEPROM) holds the scripts. Each instruction is an opcode,
+// followed by 0, 1 or 2 operand bytes:
+//   SEQ_END                      script ends (also 0xFF, erased EEPROM)
+//   SEQ_SET    maskL maskH       energise the relays in mask
+//   SEQ_CLR    maskL maskH       release the relays in mask
+//   SEQ_WAIT   n                 wait n ticks (n x 10 ms)
+//   SEQ_JMP    offset            continue at offset within the code area
+//   SEQ_WAITIN addrL addrH       wait for an activate command for this address and position
+//                                (same encoding as byte 0 and 1 of a trigger)
+// Relays are switched through relays.apply(), so interlocking rules and shortcut detection apply.
+//
+// Each script runs in its own slot, thus all scripts may run concurrently. Since command stations
+// repeat packets, a trigger is ignored while its script runs, and during the DedupTime window
+// (CV35) after the script was last started. Without that hold-off, a short script such as an
+// uncoupler pulse would end before the next repetition arrives, and run once per repetition.
+// stopAll() stops all scripts at once, for the bulk all off (Bulk.h).
+// The scripts are executed by a tick handler, thus from the main loop. Per tick, each slot
+// executes at most SEQ_BUDGET instructions; a script without WAIT in a loop can therefore not
+// block the main loop, and DCC packets keep being decoded.
+//
+// ******************************************************************************************************
+#pragma once
+#include <Arduino.h>
+#include "core_PerfectHash.h"
+
+#define MAX_SCRIPTS       4
+#define SCRIPT_TRIGGER    3
+#define SEQ_BUDGET        8               // Instructions per slot per tick
+#define NO_SCRIPT         HASH_NOT_FOUND
+
+// Opcodes
+#define SEQ_END           0x00
+#define SEQ_SET           0x01
+#define SEQ_CLR           0x02
+#define SEQ_WAIT          0x03
+#define SEQ_JMP           0x04
+#define SEQ_WAITIN        0x05
+
+class sequencer_class {
+  public:
+    uint16_t badOpcodes;                  // Scripts that were stopped due to an unknown opcode
+
+    void init(void);
+    bool affectedBy(uint16_t cvNumber);
+    uint8_t lookup(uint16_t outputAddress, uint8_t position) {
+      return triggers.lookup((outputAddress << 1) | position);
+    }
+    void start(uint8_t script);
+    void stopAll(void);
+    void input(uint16_t outputAddress, uint8_t position);  // For slots in SEQ_WAITIN
+    bool running(uint8_t script) {return (state[script] != IDLE);}
+    bool ignores(uint8_t script) {return running(script) || holdOff[script];}  // Repeated trigger
+    void update(void);                    // Called by the tick handler
+
+  private:
+    enum {IDLE, RUN, WAIT, WAITIN};
+    PerfectHash<3> triggers;              // (Output address, position) => script
+    uint8_t startPc[MAX_SCRIPTS];
+    uint8_t state[MAX_SCRIPTS];
+    uint8_t pc[MAX_SCRIPTS];              // Offset within the code area
+    uint8_t wait[MAX_SCRIPTS];            // Ticks to go (WAIT)
+    uint16_t waitKey[MAX_SCRIPTS];        // (Output address << 1) | position (WAITIN)
+    uint8_t holdOff[MAX_SCRIPTS];         // Ticks till a trigger may start the script again
+    uint8_t holdOffTicks;                 // Local copy of CV35 (DedupTime, in ticks)
+    bool registered;                      // Is the tick handler registered?
+    uint8_t fetch(uint8_t script);
+    void step(uint8_t script);
+};
+
+extern sequencer_class sequencer;
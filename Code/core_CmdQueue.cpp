@@ -0,0 +1,35 @@
+//*****************************************************************************************************
+//
+// File:      core_CmdQueue.cpp
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//
+// Purpose:   Single-producer / single-consumer ring for decoded accessory commands
+//
+//*****************************************************************************************************
+#include <Arduino.h>
+#include "core_CmdQueue.h"
+
+
+bool CmdQueue::push(const AccCommand &cmd) {
+  uint8_t next = (head + 1) & (CMD_QUEUE_SIZE - 1);
+  if (next == tail) {
+    if (overflows < 0xFFFF) overflows++;
+    return false;
+  }
+  buffer[head] = cmd;
+  CMD_QUEUE_BARRIER();                 // The entry must be complete before head moves
+  head = next;
+  uint8_t now = depth();
+  if (now > highWater) highWater = now;
+  return true;
+}
+
+
+bool CmdQueue::pop(AccCommand &cmd) {
+  if (head == tail) return false;
+  cmd = buffer[tail];
+  CMD_QUEUE_BARRIER();                 // The entry must be copied before tail moves
+  tail = (tail + 1) & (CMD_QUEUE_SIZE - 1);
+  return true;
+}
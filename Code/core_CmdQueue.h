@@ -0,0 +1,66 @@
+//*****************************************************************************************************
+//
+// File:      core_CmdQueue.h
+// Author:    Aiko Pras
+// History:   2026/01/18 AP Version 1.0
+//            2026/01/28 AP Version 1.1: Extended accessory commands
+//            2026/01/30 AP Version 1.2: Loco function group commands
+//            2026/02/01 AP Version 1.3: Bulk commands
+//
+// Purpose:   Single-producer / single-consumer ring for decoded accessory commands
+//
+// Accessory commands are decoded by the producer (commands.receive(), which calls dcc.input())
+// and applied to the relays by the consumer (commands.execute()). Between both sits this ring.
+// The producer can therefore be called from places where the consumer would take too long,
+// such as between two relay actions or serial prints, without losing packets.
+//
+// The ring is lock-free: only the producer writes `head` and only the consumer writes `tail`.
+// Both are single bytes, which the AVR reads and writes atomically. The producer fills the
+// entry before it moves `head`; a compiler barrier ensures the entry is written first.
+// One entry is always kept free, to distinguish a full ring from an empty ring.
+//
+// The ring keeps two statistics:
+// - highWater:  the maximum number of commands that were waiting at the same time
+// - overflows:  the number of commands that were dropped since the ring was full
+// If overflows remains 0, no command has been lost.
+//
+//*****************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+#define CMD_QUEUE_SIZE  16             // Must be a power of 2. Holds CMD_QUEUE_SIZE - 1 commands
+
+#define CMD_QUEUE_BARRIER()   __asm__ __volatile__ ("" ::: "memory")
+
+// Kind of command
+#define CMD_BASIC       0              // Basic accessory command
+#define CMD_EXTENDED    1              // Extended accessory command (signal aspect)
+#define CMD_FUNCTIONS   2              // Loco function group command (LocoFunctions.h)
+#define CMD_BULK        3              // Broadcast or group command (Bulk.h)
+
+// For CMD_FUNCTIONS, position holds the function group and outputAddress the function states.
+// For CMD_BULK, position holds the operation.
+struct AccCommand {
+  uint16_t outputAddress;              // 1..2048. CMD_FUNCTIONS: function states
+  uint8_t kind;                        // CMD_BASIC, CMD_EXTENDED, CMD_FUNCTIONS, CMD_BULK
+  uint8_t position;                    // CMD_BASIC: 0 or 1. CMD_EXTENDED: aspect (0..255)
+  uint8_t activate;                    // 0 or 1. Always 1 for CMD_EXTENDED and CMD_FUNCTIONS
+  uint16_t time;                       // Reception time in ms (tickScheduler.ms())
+};
+
+
+class CmdQueue {
+  public:
+    bool push(const AccCommand &cmd);  // Producer only. Returns false (and counts) if full
+    bool pop(AccCommand &cmd);         // Consumer only. Returns false if empty
+    bool empty(void) {return (head == tail);}
+    uint8_t depth(void) {return ((head - tail) & (CMD_QUEUE_SIZE - 1));}
+
+    uint8_t highWater;                 // Maximum depth seen
+    uint16_t overflows;                // Number of commands dropped
+
+  private:
+    AccCommand buffer[CMD_QUEUE_SIZE];
+    volatile uint8_t head;             // Only written by the producer
+    volatile uint8_t tail;             // Only written by the consumer
+};
@@ -4,6 +4,7 @@
 // Author:    Aiko Pras
 // History:   2021/06/14 AP V1.0
 //            2025/12/01 AP V2.0 Made specific for the TMC 16 Channel switch decoder
+//            2026/02/21 AP V2.1 CV layout (CV76): boards initialised by older software are upgraded
 //
 // Purpose:   C++ file that implements the methods to read and modify CV values stored in EEPROM,  
 //            as well as the default values for all CVs.
@@ -79,6 +80,34 @@ void CvValues::init(uint8_t decoderType, uint8_t softwareVersion) {
   //
   // print every accessory command to the serial interface?
   defaults[PrintDetails] = 0;          // 0: no, 1: yes
+  //
+  // Command stations repeat accessory commands. Repetitions within this window are ignored
+  defaults[DedupTime] = 50;             // 50 x 10ms = 0,5 sec. 0: every command is executed
+  //
+  // Mapping of channels (output addresses) to relays. Default: not inverted, channel n => relay n
+  defaults[InvertL] = 0;
+  defaults[InvertH] = 0;
+  for (uint8_t i = 0; i < 16; i++) defaults[RelayMap + i] = i + 1;
+  // The four groups of 4 channels follow each other, starting at the address in CV1/CV9
+  for (uint8_t i = 0; i < 8; i++) defaults[GroupAddr + i] = 0;
+  //
+  // Function decoder mode is off; once a loco address is set, F1..F16 drive channel 1..16
+  defaults[FuncAddrL] = 0;
+  defaults[FuncAddrH] = 0;
+  defaults[FuncFirst] = 1;
+  //
+  // Bulk operations: no group address, and all relays released as default image
+  defaults[BulkAddrL] = 0;
+  defaults[BulkAddrH] = 0;
+  defaults[DefaultL] = 0;
+  defaults[DefaultH] = 0;
+  //
+  // All channels are steady; channels in pulse mode get pulses of 25 x 10ms = 250ms
+  for (uint8_t i = 0; i < 4; i++) defaults[ChannelMode + i] = 0;
+  defaults[PulseTime] = 25;
+  //
+  // The CVs above are those of layout 1 (see upgrade())
+  defaults[CvLayout] = cvLayout;
   
 }
 
@@ -91,6 +120,11 @@ bool CvValues::notInitialised(void) {
 }
 
 
+bool CvValues::oldLayout(void) {
+  return (EEPROM.read(CvLayout) != cvLayout);
+}
+
+
 bool CvValues::addressNotSet(void) {
   // We check CV9 (decoder address High)
   return (EEPROM.read(myAddrH) == 0x80);
@@ -104,6 +138,16 @@ void CvValues::setDefaults(void) {
   // Note that defaults[0] contains the value that indicates the EEPROM has been initialised
   // Note also that the decoder type as well as software version will be overwritten.
   for (uint8_t i = 0; i <= max_cvs; i++) EEPROM.update(i, defaults[i]);
+  // The tables in the extended CV area are erased
+  for (uint16_t i = max_cvs + 1; i <= E2END; i++) EEPROM.update(i, 0xFF);
+}
+
+
+void CvValues::upgrade(void) {
+  // Only layout 0xFF precedes layout 1: software that initialised CV1..63. A later layout adds a
+  // case here for each layout before it, with the first CV it did not yet have
+  uint8_t first = FuncAddrL;
+  for (uint8_t i = first; i <= max_cvs; i++) EEPROM.update(i, defaults[i]);
 }
 
 
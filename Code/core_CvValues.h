@@ -4,6 +4,7 @@
 // Author:    Aiko Pras
 // History:   2021/06/14 AP V1.0
 //            2025/12/01 AP V2.0 Made specific for the TMC 16 Channel switch decoder
+//            2026/02/21 AP V2.1 CV layout (CV76): boards initialised by older software are upgraded
 //
 // Purpose:   Header file that defines the methods to read and modify CV values stored in EEPROM,
 //            as well as the default values for all
@@ -42,6 +43,16 @@
 // Note that the first EEPROM element will not be used by any CV, since the first CV has
 // number 1, and (for simplicity) is stored at EEPROM location 1 (EEPROM.write(1, "value CV1")).
 //
+// Upgrades
+// New software may use more CVs than the software that initialised the EEPROM. Since only
+// EEPROM.read(0) is checked, the new CVs would keep whatever the EEPROM held, usually 0xFF.
+// CV76 (CvLayout) therefore holds the layout of the CVs that setDefaults() wrote. If it differs
+// from cvLayout, CommonDecHwFunctions() calls upgrade(), which writes the defaults of the CVs that
+// were added since, and the new layout. All other CVs keep their values. Layouts:
+// - 0xFF: software before CV76 existed, which initialised CV1..63 only
+// - 1:    CV1..79 (function decoder mode, bulk operations, output modes)
+// CV76 should therefore not be changed via PoM or SM.
+//
 // Depending on the board that is being used and the specific Arduino IDE settings, EEPROM values
 // may not be erased when a new sketch is being uploaded. For example, the standard Arduino AVR Uno
 // board does not allow the EEPROM to be erased during sketch upload. The MiniCore board for the
@@ -83,7 +94,7 @@ const uint8_t TMC16ChannelSwitchDecoder         = 0b11000010;   // 16 Channel sw
 
 
 //*****************************************************************************************************
-const uint8_t max_cvs = 63;        // Maximum number of Generic CVs (that are initialised by setDefaults)
+const uint8_t max_cvs = 79;        // Maximum number of Generic CVs (that are initialised by setDefaults)
 
 // CV Names
 const uint8_t myAddrL      = 1;    // 0..63 / 0..255 - Decoder Address low. First address = 1.
@@ -101,6 +112,31 @@ const uint8_t Config       = 29;   // ...    - Accessory Decoder configuration
 const uint8_t VID_2        = 30;   // 0x0D   - Second Vendor ID (Used by my PoM software to detect these are my decoders)
 const uint8_t Shortcut     = 33;   // 40..80 - Value that indicate an output shortcut
 const uint8_t PrintDetails = 34;   // 0..1   - 1: print every accessory command to the serial interface
+const uint8_t DedupTime    = 35;   // 0..255 - Repeated accessory commands within this time (x 10ms) are ignored
+const uint8_t InvertL      = 36;   // 0..255 - Bit n set: channel n+1 is inverted (+ releases the relay)
+const uint8_t InvertH      = 37;   // 0..255 - Same, for channels 9..16
+const uint8_t RelayMap     = 40;   // 1..16  - CV40..CV55: relay driven by channel 1..16
+const uint8_t GroupAddr    = 56;   // 0..2048 - CV56..CV63: first output address of group 1..4 (L, H). 0: after CV1/CV9
+const uint8_t FuncAddrL    = 64;   // 0..255 - Loco address for function decoder mode, low byte. 0: mode off
+const uint8_t FuncAddrH    = 65;   // 0..39  - Same, high byte
+const uint8_t FuncFirst    = 66;   // 0..28  - Function that drives channel 1
+const uint8_t BulkAddrL    = 67;   // 0..255 - Group output address for bulk operations, low byte. 0: none
+const uint8_t BulkAddrH    = 68;   // 0..7   - Same, high byte
+const uint8_t DefaultL     = 69;   // 0..255 - Default relay image, relay 1..8 (bulk "all to default")
+const uint8_t DefaultH     = 70;   // 0..255 - Same, relay 9..16
+const uint8_t ChannelMode  = 71;   // 0..255 - CV71..CV74: output mode, 2 bits per channel (0 = steady, 1 = pulse, 2 = toggle)
+const uint8_t PulseTime    = 75;   // 1..255 - Pulse length (x 10ms) for channels in pulse mode
+const uint8_t CvLayout     = 76;   // 1      - Layout of the CVs that were initialised (see Upgrades above)
+
+const uint8_t cvLayout     = 1;    // Layout of this software
+
+// Tables in the extended CV area, above max_cvs. These have no defaults; setDefaults() erases
+// them (0xFF means: entry not used). The tables are described in the files that use them.
+const uint16_t RouteTable     = 128;  // CV128..CV175: 8 routes of 6 bytes (Routes.h)
+const uint16_t AspectTable    = 176;  // CV176..CV255: 4 signals of 20 bytes (Aspects.h)
+const uint16_t InterlockTable = 256;  // CV256..CV287: 8 interlocking rules of 4 bytes (Interlock.h)
+const uint16_t ScriptTable    = 288;  // CV288..CV299: 4 script triggers of 3 bytes (Sequencer.h)
+const uint16_t ScriptCode     = 300;  // CV300..end of EEPROM: script code area (Sequencer.h)
 
 
 //*****************************************************************************************************
@@ -114,6 +150,8 @@ class CvValues {
     // Functions to ensure the EEPROM is being filled
     bool notInitialised(void);                     // Checks if the EEPROM has been initialised
     void setDefaults(void);                        // Fills the decoder with the default values
+    bool oldLayout(void);                          // Initialised by software with fewer CVs?
+    void upgrade(void);                            // Defaults for the CVs that were added since
 
 
     // Generic CV functions
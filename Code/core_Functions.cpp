@@ -7,6 +7,9 @@
 //            2022/08/02 AP V1.3
 //            2025/12/01 AP V1.4: Changed, to be used within a sketch. Filename changed
 //               Anything related to RS-Bus / feedback messages removed, as well as GBM specific code 
+//            2026/01/10 AP V1.5: The programming button is interrupt driven (DccIsrButton)
+//            2026/01/16 AP V1.6: The programming LED is a PatternLed, driven by the tick scheduler
+//            2026/02/21 AP V1.7: EEPROM initialised by older software is upgraded (cvValues.upgrade())
 //
 // Purpose:   C++ file that implements the methods to act on DCC CV-messages and pushes on the 
 //            programming button. It can make changes to the LED.
@@ -25,8 +28,9 @@ class ProgButton {
 //*****************************************************************************************************
 // Objects instatiated / used in this file
 //*****************************************************************************************************
-DccLed programmingLed;                // The DccLed class is defined in core_LEDs
-DccButton onBoardButton;              // The DccButton class is defined in core_ProgButton
+PatternLed programmingLed;            // The PatternLed class is defined in core_LEDs
+typedef FastLed<LED_PROG_PORT, LED_PROG_BIT> ProgLedPin;
+DccIsrButton onBoardButton;           // The DccIsrButton class is defined in core_ProgButton
 
 // Classes defined in here
 ProgButton progButton;                // The onBoardButton is used as programming button
@@ -58,7 +62,14 @@ void Processor::reboot(void) {
 //*****************************************************************************************************
 // Programming button 
 //*****************************************************************************************************
-// The ProgButton class is basically a small wrapper around the DccButton class (see AP_DccButton)
+// The onboard button is connected to PF6. Its edges are timestamped by the PORTF pin-change ISR.
+// The other PORTF pins are used for the ADC and the PWM LEDs, and do not generate interrupts.
+ISR(PORTF_PORT_vect) {
+  onBoardButton.isr();
+}
+
+
+// The ProgButton class is basically a small wrapper around the DccIsrButton class
 void ProgButton::attach(uint8_t pin) {
   onBoardButton.attach(pin);
   delay(500);
@@ -87,7 +98,7 @@ void ProgButton::addressProgramming() {
   // CV1/CV9 (myAddrL/myAddrH): We store the output or decoder address 
   programmingLed.flashFast();
   do {
-    programmingLed.update();
+    tickScheduler.update();                    // Keeps the LED flashing
     if (dcc.input()) {
       uint8_t cv29 = cvValues.read(Config);
       bool accDecoder = bitRead(cv29,7);       // Are we an accessory decoder?
@@ -236,11 +247,14 @@ void CvProgramming::processMessage(Dcc::CmdType_t cmdType) {
 //*****************************************************************************************************
 void CommonDecHwFunctions::init(void) {
   // Should be called from setup() in the main sketch.
-  // Initialise the EEPROM (cvValues) if it has been erased. 
+  // Initialise the EEPROM (cvValues) if it has been erased, or upgrade it if older software
+  // initialised it
   if (cvValues.notInitialised()) cvValues.setDefaults();
+  else if (cvValues.oldLayout()) cvValues.upgrade();
   // attach input pins to the objects below 
   dcc.attach(dccPin, ackPin);
-  programmingLed.attach(LED_PROG);
+  ProgLedPin::attach();
+  programmingLed.attach(ProgLedPin::set);
   progButton.attach(buttonPin);
   // Set the Loco address for PoM messages 
   cvProgramming.initPoM();
@@ -251,17 +265,16 @@ void CommonDecHwFunctions::init(void) {
   // Set the Accessory address and the type of Command Station
   accCmd.setMyAddress(cvValues.storedAddress());
   accCmd.myMaster = cvValues.read(CmdStation);
-  // initializes the 20ms timer that reduces the CPU load of update()
-  TLast = millis();
+  // Start the tick scheduler; handlers may already have been added
+  tickScheduler.init();
 }  
 
 
 void CommonDecHwFunctions::update(void) {
   // Should be called from main as often as possible.
-  unsigned long TNow = millis();            // millis() is expensive, so call it only once
-  if ((TNow - TLast) >= 20) {               // 20ms passed?
-    TLast = TNow;
-    progButton.checkForNewDecoderAddress(); // Is the decoder programming button pushed?
-    programmingLed.update();                    // Control LED flashing
-  }
+  // The button check costs nearly nothing if the button was not touched, since edges are
+  // captured by the ISR. LED flashing is done by the tick handler of ledPatterns.
+  // Therefore update() no longer needs to call millis().
+  progButton.checkForNewDecoderAddress();   // Is the decoder programming button pushed?
+  tickScheduler.update();                   // Runs the tick handlers, if a tick passed
 }                            
@@ -25,17 +25,19 @@
 //                        +-> core_LEDs           - the LED object is instatiated here
 //                        +-> core_ProgButton     - the Button object is instatiated here
 //                        +-> core_Timer          - the timer is used for the programming button / LED
+//                        +-> core_Tick           - the tick scheduler for periodic tasks
 //
 //*****************************************************************************************************
 #pragma once
 
 #include <Arduino.h>                  // For general definitions
 #include <AP_DCC_library.h>           // Interface to DCC input and DCC Ack pin
-#include "hardware.h"                 // Pins and USART being used for this board
+#include "Hardware.h"                 // Pins and USART being used for this board
 #include "core_CvValues.h"            // To define and access cvValue
 #include "core_LEDs.h"                // For the programming LED
 #include "core_ProgButton.h"          // For the onboard Button
 #include "core_Timer.h"               // Allows timers to be used
+#include "core_Tick.h"                // Tick scheduler for periodic tasks
 
 
 //*****************************************************************************************************
@@ -59,7 +61,6 @@ class CommonDecHwFunctions {
   public:
     void init(void);                              // Should be called from init() in the main sketch.
     void update(void);                            // Should be called from main as often as possible.
-    unsigned long TLast;                          // Some elements of update() are called every 20ms
 };
 
 
@@ -86,5 +87,5 @@ extern CvProgramming cvProgramming;          // Instantiated in core_Functions.c
 
 // The following objects provide access to the onboard LED, as well as the
 // onboard programming button
-extern DccLed programmingLed;                // Instantiated in core_Functions.cpp
+extern PatternLed programmingLed;            // Instantiated in core_Functions.cpp
 extern CommonDecHwFunctions decoderHardware; // Instantiated in core_Functions.cpp
@@ -7,16 +7,21 @@
 //            2021-06-26 V1.2   ap extended with fade out
 //            2022-07-20 V1.3   ap divided into multiple objects, to save RAM if methods are not needed
 //            2025/12/01 V1.4   ap changed from library to be used within the sketch. Filename changed
+//            2026/01/16 V1.6   ap LedPatterns engine and PatternLed added
+//            2026/02/12 V1.7   ap times are uint32_t instead of unsigned long
+//            2026/02/20 V1.8   ap LedPatterns::add() no longer reuses the last LED if the table is full
 //
 // purpose:   Functions related to LEDs
 //
 // Object inheritance (between brackets the required RAM)
 // BasicLed (2) +--> FlashLed (11) ---> DCCLed (11)
 //              +--> FadeOutLed (23)
+// PatternLed (1) ---> LedPatterns (8 per LED + 3)
 //
 //******************************************************************************************************
 #include <Arduino.h>
 #include "core_LEDs.h"
+#include "core_Tick.h"
 
 
 //******************************************************************************************************
@@ -102,7 +107,7 @@ void FlashLed::flashFast(void) {
 void FlashLed::update(void) {
   if (mode == alwaysOn) return;                  // No update needed
   if (mode == alwaysOff) return;                 // No update needed
-  unsigned long current_time = millis();         // Storing millis() in a local variable gives shorter code
+  uint32_t current_time = millis();              // Storing millis() in a local variable gives shorter code
   if ((current_time - last_flash_time) >= 100) { // We only update the LED every 100 msec
     last_flash_time = current_time;
     --flash_time_remain;                         // Another 100 msec passed
@@ -180,7 +185,7 @@ void FadeOutLed::fadeOut(void) {
 
 void FadeOutLed::update(void) {
   // Is it time to lower the LED's brightness?
-  unsigned long Fade_Interval = micros() - last_fade_time;
+  uint32_t Fade_Interval = micros() - last_fade_time;
   if (Fade_Interval > (fadeStepTime)) {
     if (brightnessLevel >= 1) brightnessLevel--;
     pwmOnTime = pwmInterval / 100 * brightnessLevel ;
@@ -188,7 +193,7 @@ void FadeOutLed::update(void) {
     last_fade_time = micros();
   }
   // Below the code for PWM
-  unsigned long PWM_Interval = micros() - last_pwm_time;
+  uint32_t PWM_Interval = micros() - last_pwm_time;
   if (fadeLedIsOn) {
     if (PWM_Interval > pwmOnTime) {       // pwmOnTime is over: LED has been on long enough
       last_pwm_time = micros();;
@@ -204,3 +209,105 @@ void FadeOutLed::update(void) {
     }
   }
 }
+
+
+//******************************************************************************************************
+// Patterns
+//******************************************************************************************************
+// The timing of these patterns is equal to the timing used by FlashLed and DccLed
+const uint8_t patternFlashSlow[] PROGMEM = {PAT_ON(5), PAT_OFF(5), PAT_REPEAT};
+const uint8_t patternFlashFast[] PROGMEM = {PAT_ON(1), PAT_OFF(2), PAT_REPEAT};
+const uint8_t patternStartUp[]   PROGMEM = {PAT_ON(2), PAT_OFF(2), PAT_ON(2), PAT_END};
+const uint8_t patternActivity[]  PROGMEM = {PAT_ON(2), PAT_END};
+const uint8_t patternFeedback[]  PROGMEM = {PAT_ON(5), PAT_END};
+// `count` flashes, followed by a pause of 1,5 seconds. Used to show a channel number
+const uint8_t patternBlinkCode[] PROGMEM = {PAT_ON(3), PAT_OFF(3), PAT_LOOP, PAT_OFF(15), PAT_REPEAT};
+
+
+//******************************************************************************************************
+// LedPatterns
+//******************************************************************************************************
+LedPatterns ledPatterns;
+
+void ledPatternsTick(void) {
+  ledPatterns.update();
+}
+
+
+uint8_t LedPatterns::add(LedSetter newSetter) {
+  // The tick handler is only registered once the first LED is added
+  if (numLeds == 0) tickScheduler.add(ledPatternsTick);
+  if (numLeds >= MAX_PATTERN_LEDS) return NO_PATTERN_LED;
+  setter[numLeds] = newSetter;
+  newSetter(false);
+  return numLeds++;
+}
+
+
+void LedPatterns::start(uint8_t led, const uint8_t *newPattern, uint8_t newCount) {
+  if (led >= numLeds) return;
+  if (newCount == 0) newCount = 1;
+  pattern[led] = newPattern;
+  index[led] = 0;
+  count[led] = newCount;
+  countInit[led] = newCount;
+  active |= (1 << led);
+  step(led);                                     // The first step starts immediately
+}
+
+
+void LedPatterns::set(uint8_t led, bool on) {
+  if (led >= numLeds) return;
+  active &= ~(1 << led);
+  setter[led](on);
+}
+
+
+bool LedPatterns::running(uint8_t led) {
+  if (led >= numLeds) return false;
+  return (active & (1 << led));
+}
+
+
+void LedPatterns::update(void) {
+  if (!active) return;                           // No patterns: nothing to do
+  if (++divider < (100 / TICK_MS)) return;       // Patterns use 100ms steps
+  divider = 0;
+  for (uint8_t led = 0; led < numLeds; led++) {
+    if (!(active & (1 << led))) continue;
+    if (--remain[led] == 0) step(led);
+  }
+}
+
+
+void LedPatterns::step(uint8_t led) {
+  // Execute control codes until the next on/off step is found
+  for (;;) {
+    uint8_t code = pgm_read_byte(pattern[led] + index[led]);
+    index[led]++;
+    switch (code) {
+      case PAT_END:
+        set(led, false);
+        return;
+      case PAT_REPEAT:
+        index[led] = 0;
+        count[led] = countInit[led];
+      break;
+      case PAT_LOOP:
+        if (--count[led]) index[led] = 0;
+      break;
+      default:
+        setter[led](code & 0x80);
+        remain[led] = code & 0x7F;
+        return;
+    }
+  }
+}
+
+
+//******************************************************************************************************
+// PatternLed
+//******************************************************************************************************
+void PatternLed::attach(LedSetter setter) {
+  id = ledPatterns.add(setter);
+}
@@ -7,6 +7,10 @@
 //            2022-07-20 V1.3   ap split into multiple objects, to save RAM if methods are not needed
 //            2022-08-02 V1.4   ap const static uint8_t replaced by #defines
 //            2025/12/01 V1.4   ap changed from library to be used within the sketch. Filename changed
+//            2026/01/12 V1.5   ap FastLed template added
+//            2026/01/16 V1.6   ap LedPatterns engine and PatternLed added
+//            2026/02/12 V1.7   ap times are uint32_t instead of unsigned long
+//            2026/02/20 V1.8   ap NO_PATTERN_LED if the LedPatterns table is full
 //
 // purpose:   LED object. LED can be switched on, switched off, put in flashing mode or fade out.
 //            Next to these basic modes, additional functions are defined for some common tasks,
@@ -17,15 +21,23 @@
 // - FlashLed:    extends BasicLed with flashing
 // - DccLed:      extends FlashLed with DCC decoder specific functions (start_up, activity, feedback)
 // - FadeOutLed:  extends BasicLed with fadeOut (not recommeded: is expensive regarding RAM and CPU)
+//                For LED_DCC and LED_ACC the hardware PWM of pwmLeds (Hardware.h) should be used instead
+// - FastLed:     template with the same on/off interface as BasicLed, but the pin is fixed at
+//                compile time. Use this if the pin is known in advance (which is normally the case)
+// - PatternLed:  same interface as DccLed, but the flash patterns are byte sequences in flash
+//                that are played by a single LedPatterns engine for all LEDs (see below)
 //
 // RAM required per object:
 // - BasicLed:     2
 // - FlashLed:    11
 // - DccLed:      11
 // - FadeOutLed:  23
+// - FastLed:      0 (all methods are static; the compiler still reserves 1 byte per object)
+// - PatternLed:   1 (plus 8 per LED within the LedPatterns engine)
 //
 //******************************************************************************************************
 #pragma once
+#include <Arduino.h>
 
 
 //******************************************************************************************************
@@ -45,6 +57,56 @@ protected:
 };
 
 
+//******************************************************************************************************
+// FastLed
+//******************************************************************************************************
+// BasicLed stores the pin number and polarity in RAM, and uses digitalWrite() / digitalRead().
+// Each of these calls has to map the pin number to a port and bitmask at runtime. FastLed gets
+// the port, bit and polarity as template parameters, so all of this is resolved by the compiler:
+// - turn_on() / turn_off() become a single SBI or CBI instruction on the VPORT register
+// - toggle() becomes a single write to VPORTx.IN (which toggles the output on the Dx-series)
+// - ledIsOn() tests the output latch (VPORTx.OUT), instead of reading the input pin
+// PORTNUM is PA, PB, PC, ... (as defined by DxCore), BIT is 0..7. Example:
+//   FastLed<PA, 3> errorLed;
+//   errorLed.attach();
+//   errorLed.turn_on();
+//******************************************************************************************************
+template <uint8_t PORTNUM, uint8_t BIT, bool INVERT = false>
+class FastLed {
+public:
+  static inline void attach(void) {
+    turn_off();
+    vport().DIR |= (1 << BIT);
+  }
+
+  static inline bool ledIsOn(void) {
+    return ((vport().OUT & (1 << BIT)) != 0) != INVERT;
+  }
+
+  static inline void turn_on(void) {
+    if (INVERT) vport().OUT &= ~(1 << BIT);
+    else vport().OUT |= (1 << BIT);
+  }
+
+  static inline void turn_off(void) {
+    if (INVERT) vport().OUT |= (1 << BIT);
+    else vport().OUT &= ~(1 << BIT);
+  }
+
+  static inline void set(bool on) {
+    if (on) turn_on();
+    else turn_off();
+  }
+
+  static inline void toggle(void) {
+    vport().IN = (1 << BIT);
+  }
+
+private:
+  static inline VPORT_t &vport(void) {return (&VPORTA)[PORTNUM];}
+};
+
+
 //******************************************************************************************************
 // FlashLed
 //******************************************************************************************************
@@ -90,7 +152,7 @@ public:
   void update(void);              // Should be called from main as often as possible
 
 protected:
-  unsigned long last_flash_time;  // time in msec since we last updated the LEDs
+  uint32_t last_flash_time;       // time in msec since we last updated the LEDs
   uint8_t flash_number_now;       // Number of flashes thusfar
   uint8_t flash_time_remain;      // Remaining time before LED status changes. In Ticks (100ms)
 };
@@ -163,9 +225,98 @@ private:
     uint16_t pwmInterval;           // in microseconds, see figures above
     uint16_t pwmOnTime;             // in microseconds, see figures above
     uint16_t pwmOffTime;            // in microseconds, see figures above
-    unsigned long last_fade_time;   // time (ms) since we last updated the fade settings
-    unsigned long last_pwm_time;    // time (ms) since we last updated the PWM settings
+    uint32_t last_fade_time;        // time (ms) since we last updated the fade settings
+    uint32_t last_pwm_time;         // time (ms) since we last updated the PWM settings
     bool fadeLedIsOn;               // for performance reasons we don't use BasicLed::ledIsOn()
     uint8_t brightnessLevel;        // Current LED level
 };
 
+
+
+//******************************************************************************************************
+// LedPatterns
+//******************************************************************************************************
+// FlashLed and DccLed describe a flash pattern by a set of attributes, and each LED object calls
+// millis() in its own update(). The LedPatterns engine instead plays patterns that are stored as
+// byte sequences in flash (PROGMEM). A single tick handler (see core_Tick) advances all registered
+// LEDs in one pass, every 100ms. If no pattern is running, the handler returns immediately.
+//
+// Each pattern byte is either a step or a control code:
+// - bit 7 = LED on (1) or off (0), bit 0..6 = duration of this step in 100ms units (1..125)
+// - PAT_END:    end of the pattern, LED off
+// - PAT_REPEAT: restart the pattern from the beginning (continuous patterns)
+// - PAT_LOOP:   restart from the beginning until the pattern has been played `count` times,
+//               where count is given to start(). Used for blink codes, such as a channel number.
+// Example: {PAT_ON(3), PAT_OFF(3), PAT_LOOP, PAT_OFF(15), PAT_REPEAT} blinks `count` times,
+// waits 1,5 seconds and starts again.
+//
+// LEDs are registered by add(), with a function that switches that LED on or off. For a LED on
+// a fixed pin this can be the set() method of a FastLed template, for example:
+//   id = ledPatterns.add(FastLed<PA, 3>::set);
+// If all MAX_PATTERN_LEDS are taken, add() returns NO_PATTERN_LED; the other methods ignore that id.
+//******************************************************************************************************
+#define PAT_END             0x00
+#define PAT_REPEAT          0x80
+#define PAT_LOOP            0x7F
+#define PAT_ON(time)        (0x80 | (time))
+#define PAT_OFF(time)       (time)
+
+#define MAX_PATTERN_LEDS    4
+#define NO_PATTERN_LED      0xFF
+
+typedef void (*LedSetter)(bool on);
+
+// Patterns used by PatternLed. Defined in core_LEDs.cpp
+extern const uint8_t patternFlashSlow[];
+extern const uint8_t patternFlashFast[];
+extern const uint8_t patternStartUp[];
+extern const uint8_t patternActivity[];
+extern const uint8_t patternFeedback[];
+extern const uint8_t patternBlinkCode[];
+
+class LedPatterns {
+public:
+  uint8_t add(LedSetter setter);                      // Returns the id of the LED, or NO_PATTERN_LED
+  void start(uint8_t led, const uint8_t *pattern, uint8_t count=1);
+  void set(uint8_t led, bool on);                     // Stops a running pattern
+  bool running(uint8_t led);
+  void update(void);                                  // Called by the tick scheduler
+
+private:
+  void step(uint8_t led);
+  LedSetter setter[MAX_PATTERN_LEDS];
+  const uint8_t *pattern[MAX_PATTERN_LEDS];           // Pattern in PROGMEM
+  uint8_t index[MAX_PATTERN_LEDS];                    // Next byte of the pattern
+  uint8_t remain[MAX_PATTERN_LEDS];                   // 100ms steps till the next pattern byte
+  uint8_t count[MAX_PATTERN_LEDS];                    // For PAT_LOOP
+  uint8_t countInit[MAX_PATTERN_LEDS];                // count is reloaded by PAT_REPEAT
+  uint8_t active;                                     // Bit n set: a pattern runs on LED n
+  uint8_t numLeds;
+  uint8_t divider;                                    // Ticks within a 100ms step
+};
+
+extern LedPatterns ledPatterns;                       // Instantiated in core_LEDs.cpp
+
+
+//******************************************************************************************************
+// PatternLed
+//******************************************************************************************************
+// A PatternLed has the same methods as a DccLed, but only stores its id within ledPatterns.
+// update() is not needed, but kept (empty) for compatibility with FlashLed and DccLed.
+class PatternLed {
+public:
+  void attach(LedSetter setter);
+  void turn_on(void)  {ledPatterns.set(id, true);}
+  void turn_off(void) {ledPatterns.set(id, false);}
+  void flashSlow(void){ledPatterns.start(id, patternFlashSlow);}
+  void flashFast(void){ledPatterns.start(id, patternFlashFast);}
+  void start_up(void) {ledPatterns.start(id, patternStartUp);}
+  void activity(void) {ledPatterns.start(id, patternActivity);}
+  void feedback(void) {ledPatterns.start(id, patternFeedback);}
+  void blinkCode(uint8_t number) {ledPatterns.start(id, patternBlinkCode, number);}
+  bool running(void)  {return ledPatterns.running(id);}
+  void update(void) {}
+
+private:
+  uint8_t id = NO_PATTERN_LED;
+};
@@ -0,0 +1,86 @@
+//*****************************************************************************************************
+//
+// File:      core_PerfectHash.h
+// Author:    Aiko Pras
+// History:   2026/01/24 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Linear scan if no multiplier is found
+//
+// Purpose:   Small collision-free hash table, to map 16-bit keys (addresses) to a byte value
+//
+// The set of keys (for example the addresses a decoder listens to) is only known after the CVs
+// have been read, but does not change afterwards. build() therefore searches, once, a multiplier
+// for which all keys hash to different slots. lookup() is then always constant-time: a 16x16 bit
+// multiplication, a shift and one compare, independent of the number of keys.
+//
+// The table has 2^BITS slots, and can hold up to 2^BITS keys; in practice the search is fast if
+// at most half of the slots are used. Keys must be below 0xFFFF, which marks an empty slot.
+// Duplicate keys are ignored (the first one wins).
+// If none of the 256 multipliers that build() tries is collision-free, the keys are stored in
+// order instead, and lookup() compares them one by one. Lookups then still find every key, only
+// slower; build() returns false, but the table can be used as before.
+// RAM: 3 + 3 * 2^BITS bytes.
+//
+//*****************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+#define HASH_EMPTY        0xFFFF
+#define HASH_NOT_FOUND    0xFF
+
+template <uint8_t BITS>
+class PerfectHash {
+  public:
+    static const uint8_t SLOTS = (1 << BITS);
+
+    // Builds the table. Returns false if no collision-free multiplier was found (linear scan)
+    bool build(const uint16_t *keys, const uint8_t *values, uint8_t number) {
+      linear = false;
+      for (uint16_t attempt = 0; attempt < 256; attempt++) {
+        multiplier = 0x9E37 + (attempt << 1);            // Odd, starting at 2^16 / golden ratio
+        clear();
+        bool ok = true;
+        for (uint8_t i = 0; (i < number) && ok; i++) {
+          if (keys[i] == HASH_EMPTY) continue;
+          uint8_t slot = hash(keys[i]);
+          if (key[slot] == keys[i]) continue;            // Duplicate key
+          if (key[slot] != HASH_EMPTY) ok = false;       // Collision: try the next multiplier
+          key[slot] = keys[i];
+          value[slot] = values[i];
+        }
+        if (ok) return true;
+      }
+      clear();
+      uint8_t used = 0;
+      for (uint8_t i = 0; (i < number) && (used < SLOTS); i++) {
+        if (keys[i] == HASH_EMPTY) continue;
+        key[used] = keys[i];
+        value[used++] = values[i];
+      }
+      linear = true;
+      return false;
+    }
+
+    // Returns the value that belongs to this key, or HASH_NOT_FOUND
+    uint8_t lookup(uint16_t searchKey) {
+      if (linear) {
+        for (uint8_t i = 0; i < SLOTS; i++) if (key[i] == searchKey) return value[i];
+        return HASH_NOT_FOUND;
+      }
+      uint8_t slot = hash(searchKey);
+      if (key[slot] != searchKey) return HASH_NOT_FOUND;
+      return value[slot];
+    }
+
+    bool linear;                                         // No multiplier found: lookup() scans
+
+  private:
+    uint16_t multiplier;
+    uint16_t key[SLOTS];
+    uint8_t value[SLOTS];
+
+    uint8_t hash(uint16_t k) {return (uint16_t)((unsigned int)k * multiplier) >> (16 - BITS);}
+
+    void clear(void) {
+      for (uint8_t i = 0; i < SLOTS; i++) key[i] = HASH_EMPTY;
+    }
+};
@@ -8,6 +8,8 @@
 //                              interface resemble the other AP_DCC and RSBus libraries
 //            2025/12/01 V1.2   Changed from library to be used within the sketch.
 //                              Filename changed
+//            2026/01/10 V1.3   DccIsrButton added
+//            2026/02/12 V1.4   Times are uint32_t instead of unsigned long
 //
 // purpose:   Reads the status of (debounced) buttons
 //
@@ -43,7 +45,7 @@
 //*******************************************************************************************
 // attach and initialize a DccButton object and the pin it's connected to.
 //*******************************************************************************************
-void DccButton::attach(uint8_t pin, unsigned long dbTime, bool puEnable, bool invert) {
+void DccButton::attach(uint8_t pin, uint32_t dbTime, bool puEnable, bool invert) {
   m_pin = pin;
   m_dbTime = dbTime;
   m_puEnable = puEnable;
@@ -72,7 +74,7 @@ void DccButton::attach(uint8_t pin, unsigned long dbTime, bool puEnable, bool in
 // does debouncing, captures and maintains times, previous state, etc.
 //*******************************************************************************************
 bool DccButton::read() {
-  unsigned long ms = millis();
+  uint32_t ms = millis();
   bool pinVal = (*m_portRegister & m_bit);
   // bool pinVal = (PIND & (1<<PD3);      // Direct port access: fast but hardcoded
   // bool pinVal = digitalRead(m_pin);    // Standard Arduino, flexible but slow
@@ -122,17 +124,138 @@ bool DccButton::wasReleased() {
 // Returns false (0) or true (!=0) accordingly.
 // These functions do not cause the button to be read.
 //*******************************************************************************************
-bool DccButton::pressedFor(unsigned long ms) {
+bool DccButton::pressedFor(uint32_t ms) {
   return m_state && m_time - m_lastChange >= ms;
 }
 
-bool DccButton::releasedFor(unsigned long ms) {
+bool DccButton::releasedFor(uint32_t ms) {
   return !m_state && m_time - m_lastChange >= ms;
 }
 
 //*******************************************************************************************
 // lastChange() returns the time the button last changed state, in milliseconds.                                                     *
 //*******************************************************************************************
-unsigned long DccButton::lastChange() {
+uint32_t DccButton::lastChange() {
+  return m_lastChange;
+}
+
+
+//*******************************************************************************************
+// DccIsrButton
+//*******************************************************************************************
+// Updated: 10 january 2026
+// DccButton::read() calls millis() and reads the input port each time it is called, even if
+// nobody touches the button. DccIsrButton lets the pin-change interrupt do the sampling: the
+// ISR stores for every edge the time and the resulting pin level in a queue of 4 entries.
+// read() drains that queue and applies the same debounce rule as DccButton: a change of
+// state is only accepted if at least dbTime ms passed since the previous change. If an edge
+// was ignored since it came too early, the pin will be read once more after the debounce
+// time, to ensure the final level of a bouncing button is not missed.
+// If the button is released and no edges are queued, read() returns immediately.
+//*******************************************************************************************
+void DccIsrButton::attach(uint8_t pin, uint32_t dbTime, bool puEnable, bool invert) {
+  m_dbTime = dbTime;
+  m_invert = invert;
+  pinMode(pin, puEnable ? INPUT_PULLUP : INPUT);
+  m_bit = digitalPinToBitMask(pin);
+  m_portRegister = portInputRegister(digitalPinToPort(pin));
+  m_portStruct = digitalPinToPortStruct(pin);
+  m_state = (*m_portRegister & m_bit);
+  if (m_invert) m_state = !m_state;
+  m_changed = false;
+  m_resample = false;
+  m_time = millis();
+  m_lastChange = m_time;
+  m_head = 0;
+  m_tail = 0;
+  m_lost = false;
+  // Enable the interrupt on both edges. The pull-up setting from pinMode() is kept
+  volatile uint8_t *pinCtrl = &m_portStruct->PIN0CTRL + digitalPinToBitPosition(pin);
+  *pinCtrl = (*pinCtrl & ~PORT_ISC_gm) | PORT_ISC_BOTHEDGES_gc;
+}
+
+
+void DccIsrButton::isr() {
+  // All flags of this port are cleared, to avoid the ISR being called over and over again
+  // for pins that are not handled here.
+  uint8_t flags = m_portStruct->INTFLAGS;
+  m_portStruct->INTFLAGS = flags;
+  if (!(flags & m_bit)) return;
+  uint8_t next = (m_head + 1) & (EDGE_QUEUE_SIZE - 1);
+  if (next == m_tail) {                        // Queue full: read() will sample the pin itself
+    m_lost = true;
+    return;
+  }
+  m_edgeTime[m_head] = millis();
+  if (*m_portRegister & m_bit) m_edgeLevel |= (1 << m_head);
+  else m_edgeLevel &= ~(1 << m_head);
+  m_head = next;
+}
+
+
+bool DccIsrButton::read() {
+  m_changed = false;
+  uint8_t head = m_head;                       // Edges queued after this are handled next time
+  if ((head == m_tail) && !m_state && !m_resample && !m_lost) return false;
+  uint32_t ms = millis();
+  bool previous = m_state;
+  while (m_tail != head) {
+    uint8_t tail = m_tail;
+    bool level = (m_edgeLevel >> tail) & 1;
+    if (m_invert) level = !level;
+    uint32_t edgeTime = m_edgeTime[tail];
+    m_tail = (tail + 1) & (EDGE_QUEUE_SIZE - 1);
+    if (level == m_state) m_resample = false;  // Bounced back to the current state
+    else if (edgeTime - m_lastChange < m_dbTime) m_resample = true;
+    else {
+      m_state = level;
+      m_lastChange = edgeTime;
+      m_resample = false;
+    }
+  }
+  if (m_lost) {
+    m_lost = false;
+    m_resample = true;
+  }
+  if (m_resample && (ms - m_lastChange >= m_dbTime)) {
+    bool pinVal = (*m_portRegister & m_bit);
+    if (m_invert) pinVal = !pinVal;
+    m_resample = false;
+    if (pinVal != m_state) {
+      m_state = pinVal;
+      m_lastChange = ms;
+    }
+  }
+  m_changed = (m_state != previous);
+  m_time = ms;
+  return m_state;
+}
+
+
+bool DccIsrButton::isPressed() {
+  return m_state;
+}
+
+bool DccIsrButton::isReleased() {
+  return !m_state;
+}
+
+bool DccIsrButton::wasPressed() {
+  return m_state && m_changed;
+}
+
+bool DccIsrButton::wasReleased() {
+  return !m_state && m_changed;
+}
+
+bool DccIsrButton::pressedFor(uint32_t ms) {
+  return m_state && m_time - m_lastChange >= ms;
+}
+
+bool DccIsrButton::releasedFor(uint32_t ms) {
+  return !m_state && m_time - m_lastChange >= ms;
+}
+
+uint32_t DccIsrButton::lastChange() {
   return m_lastChange;
 }
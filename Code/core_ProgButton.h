@@ -10,6 +10,10 @@
 //                              digitalRead() is replaced by a register pointer and mask
 //            2025/12/01 V1.3   Changed from library to be used within the sketch
 //                              Filename changed
+//            2026/01/10 V1.4   DccIsrButton added: edges are timestamped by the pin-change
+//                              interrupt, debouncing is only done if an edge occurred
+//            2026/01/12 V1.5   FastButton template added: port and bit fixed at compile time
+//            2026/02/12 V1.6   Times are uint32_t instead of unsigned long
 //
 // purpose:   Reads the status of (debounced) buttons
 //
@@ -34,7 +38,7 @@ public:
   // invert   true to interpret a low logic level as pressed (default true)
   
   // Initialize a Button object and the pin it's connected to
-  void attach(uint8_t pin, unsigned long dbTime=25, bool puEnable=true, bool invert=true);
+  void attach(uint8_t pin, uint32_t dbTime=25, bool puEnable=true, bool invert=true);
   
   // Returns the current debounced button state, true for pressed,
   // false for released. Call this function frequently to ensure
@@ -59,27 +63,27 @@ public:
   
   // Returns true if the button state at the last call to read() was pressed,
   // and has been in that state for at least the given number of milliseconds.
-  bool pressedFor(unsigned long ms);
+  bool pressedFor(uint32_t ms);
   
   // Returns true if the button state at the last call to read() was released,
   // and has been in that state for at least the given number of milliseconds.
-  bool releasedFor(unsigned long ms);
+  bool releasedFor(uint32_t ms);
   
   // Returns the time in milliseconds (from millis) that the button last
   // changed state.
-  unsigned long lastChange();
+  uint32_t lastChange();
   
 private:
   uint8_t m_pin;                    // arduino pin number connected to button
-  unsigned long m_dbTime;           // debounce time (ms)
+  uint32_t m_dbTime;                // debounce time (ms)
   bool m_puEnable;                  // internal pullup resistor enabled
   bool m_invert;                    // if true, interpret logic low as pressed,
                                     // else interpret logic high as pressed
   bool m_state;                     // current button state, true=pressed
   bool m_lastState;                 // previous button state
   bool m_changed;                   // state changed since last read
-  unsigned long m_time;             // time of current state (ms from millis)
-  unsigned long m_lastChange;       // time of last state change (ms)
+  uint32_t m_time;                  // time of current state (ms from millis)
+  uint32_t m_lastChange;            // time of last state change (ms)
   
   // The following was added in december 2021. Instead of using the standard and
   // slow Arduino digitalRead() function, we use a pointer to the inpu port the
@@ -100,7 +104,7 @@ class ToggleButton : public DccButton {
 public:
   
   // attach is similar to Button, but includes the initial state for the toggle.
-  void attach(uint8_t pin, unsigned long dbTime=25, bool puEnable=true,
+  void attach(uint8_t pin, uint32_t dbTime=25, bool puEnable=true,
               bool invert=true, bool initialState=false) {
     DccButton::attach(pin, dbTime, puEnable, invert);
     m_toggleState = initialState;
@@ -131,3 +135,126 @@ private:
   bool m_toggleState;
   bool m_changed;
 };
+
+
+//*******************************************************************************************
+// DccIsrButton
+// An interrupt driven variant of DccButton, with the same interface.
+// The pin-change interrupt of the button's port stores the time and pin level of each edge
+// in a small queue. read() only evaluates debounce and timing if an edge was queued, or if
+// the button is (still) pressed; in all other cases read() returns immediately, without
+// calling millis() or reading the input port.
+//
+// The ISR itself is not part of this class, since the interrupt vector depends on the port
+// the button is connected to. The sketch should define it and call isr(), for example:
+//   ISR(PORTF_PORT_vect) { onBoardButton.isr(); }
+// Note that the ISR is called for edges on all pins of that port that have their
+// interrupt enabled; isr() only handles the button's own pin.
+//
+// Since read() skips all work while the button is released, releasedFor() compares against
+// the time of the last edge that was evaluated, and not against the current time.
+//*******************************************************************************************
+#define EDGE_QUEUE_SIZE   4         // Must be a power of 2
+
+class DccIsrButton {
+  
+public:
+  // Parameters are the same as for DccButton::attach()
+  void attach(uint8_t pin, uint32_t dbTime=25, bool puEnable=true, bool invert=true);
+  
+  bool read();                      // Evaluates the queued edges (if any)
+  bool isPressed();
+  bool isReleased();
+  bool wasPressed();
+  bool wasReleased();
+  bool pressedFor(uint32_t ms);
+  bool releasedFor(uint32_t ms);
+  uint32_t lastChange();
+  
+  void isr();                       // To be called from the port's pin-change ISR
+  
+private:
+  uint32_t m_dbTime;                // debounce time (ms)
+  bool m_invert;                    // if true, interpret logic low as pressed
+  bool m_state;                     // current button state, true=pressed
+  bool m_changed;                   // state changed since last read
+  bool m_resample;                  // an edge was ignored while debouncing: read the pin later
+  uint32_t m_time;                  // time of the last evaluation (ms from millis)
+  uint32_t m_lastChange;            // time of last state change (ms)
+  
+  uint8_t m_bit;                    // Bitmask for reading the input Port
+  volatile uint8_t *m_portRegister; // Input register of the port
+  PORT_t *m_portStruct;             // Needed to clear the interrupt flags
+  
+  // Edge queue. Only the ISR writes m_head, only read() writes m_tail
+  volatile uint32_t m_edgeTime[EDGE_QUEUE_SIZE];
+  volatile uint8_t m_edgeLevel;     // bit n: pin level after edge n
+  volatile uint8_t m_head;
+  volatile uint8_t m_tail;
+  volatile bool m_lost;             // Set by the ISR if the queue was full
+};
+
+
+//*******************************************************************************************
+// FastButton
+// A compile-time variant of DccButton. The port, bit and polarity are template parameters,
+// so the pin is read with a single instruction (SBIS / SBIC on VPORTx.IN) and no pin number,
+// port pointer or bitmask is stored in RAM. Debouncing is identical to DccButton.
+// PORTNUM is PA, PB, PC, ... (as defined by DxCore), BIT is 0..7. Example:
+//   FastButton<PF, 6> button;
+//   button.attach();
+//*******************************************************************************************
+template <uint8_t PORTNUM, uint8_t BIT, bool INVERT = true>
+class FastButton {
+
+public:
+  void attach(uint32_t dbTime=25, bool puEnable=true) {
+    m_dbTime = dbTime;
+    (&PORTA)[PORTNUM].DIRCLR = (1 << BIT);
+    volatile uint8_t *pinCtrl = &(&PORTA)[PORTNUM].PIN0CTRL + BIT;
+    if (puEnable) *pinCtrl |= PORT_PULLUPEN_bm;
+    else *pinCtrl &= ~PORT_PULLUPEN_bm;
+    m_state = pinPressed();
+    m_time = millis();
+    m_lastState = m_state;
+    m_changed = false;
+    m_lastChange = m_time;
+  }
+
+  static inline bool pinPressed(void) {
+    return ((vport().IN & (1 << BIT)) != 0) != INVERT;
+  }
+
+  bool read() {
+    uint32_t ms = millis();
+    bool pinVal = pinPressed();
+    if (ms - m_lastChange < m_dbTime) {
+      m_changed = false;
+    }
+    else {
+      m_lastState = m_state;
+      m_state = pinVal;
+      m_changed = (m_state != m_lastState);
+      if (m_changed) m_lastChange = ms;
+    }
+    m_time = ms;
+    return m_state;
+  }
+
+  bool isPressed() {return m_state;}
+  bool isReleased() {return !m_state;}
+  bool wasPressed() {return m_state && m_changed;}
+  bool wasReleased() {return !m_state && m_changed;}
+  bool pressedFor(uint32_t ms) {return m_state && m_time - m_lastChange >= ms;}
+  bool releasedFor(uint32_t ms) {return !m_state && m_time - m_lastChange >= ms;}
+  uint32_t lastChange() {return m_lastChange;}
+
+private:
+  static inline VPORT_t &vport(void) {return (&VPORTA)[PORTNUM];}
+  uint32_t m_dbTime;                // debounce time (ms)
+  bool m_state;                     // current button state, true=pressed
+  bool m_lastState;                 // previous button state
+  bool m_changed;                   // state changed since last read
+  uint32_t m_time;                  // time of current state (ms from millis)
+  uint32_t m_lastChange;            // time of last state change (ms)
+};
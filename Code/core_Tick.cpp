@@ -0,0 +1,82 @@
+//*****************************************************************************************************
+//
+// File:      core_Tick.cpp
+// Author:    Aiko Pras
+// History:   2026/01/14 AP Version 1.0
+//            2026/02/07 AP Version 1.1: Compare within the ISR, for pulse ends
+//
+// Purpose:   Tick scheduler, to run periodic tasks from the main loop
+//
+// TCB1 runs in periodic interrupt mode on CLK_PER / 2. With CCMP = F_CPU / 2000 - 1 the
+// interrupt fires every millisecond (at 24 MHz: CCMP = 11999).
+// Note that tone() also uses TCB1 by default, and can therefore not be used.
+//
+//*****************************************************************************************************
+#include <Arduino.h>
+#include "core_Tick.h"
+
+TickScheduler tickScheduler;
+
+
+ISR(TCB1_INT_vect) {
+  tickScheduler.isr();
+}
+
+
+void TickScheduler::init(void) {
+  TCB1.CTRLA = 0;                             // Stop the timer while we configure it
+  TCB1.CTRLB = TCB_CNTMODE_INT_gc;            // Periodic interrupt mode
+  TCB1.CCMP = (F_CPU / 2000) - 1;             // 1 ms
+  TCB1.CNT = 0;
+  TCB1.INTFLAGS = TCB_CAPT_bm;                // clear flag
+  TCB1.INTCTRL = TCB_CAPT_bm;                 // enable interrupt
+  TCB1.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+}
+
+
+bool TickScheduler::add(TickHandler handler) {
+  if (numHandlers >= MAX_TICK_HANDLERS) return false;
+  handlers[numHandlers++] = handler;
+  return true;
+}
+
+
+void TickScheduler::update(void) {
+  if (isrTicks == ticks) return;              // Single byte compare: no tick passed
+  ticks++;
+  for (uint8_t i = 0; i < numHandlers; i++) handlers[i]();
+}
+
+
+uint16_t TickScheduler::ms(void) {
+  // A 16 bit read is not atomic. Save SREG, so ms() may also be called with interrupts disabled
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t value = msCount;
+  SREG = oldSREG;
+  return value;
+}
+
+
+void TickScheduler::compare(uint16_t atMs, CompareHandler handler) {
+  uint8_t oldSREG = SREG;
+  cli();
+  compareMs = atMs;
+  compareHandler = handler;
+  compareArmed = true;
+  SREG = oldSREG;
+}
+
+
+void TickScheduler::isr(void) {
+  TCB1.INTFLAGS = TCB_CAPT_bm;                // clear flag
+  msCount++;
+  if (compareArmed && (msCount == compareMs)) {
+    compareArmed = false;                     // The handler may arm it again
+    compareHandler(msCount);
+  }
+  if (++msInTick >= TICK_MS) {
+    msInTick = 0;
+    isrTicks++;
+  }
+}
@@ -0,0 +1,64 @@
+//*****************************************************************************************************
+//
+// File:      core_Tick.h
+// Author:    Aiko Pras
+// History:   2026/01/14 AP Version 1.0
+//            2026/02/07 AP Version 1.1: Compare within the ISR, for pulse ends
+//
+// Purpose:   Tick scheduler, to run periodic tasks from the main loop
+//
+// Several objects need regular, but not very precise, service: LED flashing and fading, timed
+// relay actions etc. Before, each of these objects called millis() itself to determine if it had
+// something to do, which costs time on every pass of the main loop, also if nothing happens.
+//
+// The TickScheduler uses TCB1 in periodic interrupt mode. The ISR fires every millisecond and
+// increments a millisecond counter; every TICK_MS milliseconds it also increments a tick counter.
+// update() should be called from main as often as possible. It compares the tick counter from the
+// ISR with the number of ticks it has handled thusfar; only if a new tick occurred it calls the
+// registered handlers. If no tick occurred, update() costs a single compare.
+// The handlers run in the context of the main loop, and not within the ISR. Therefore they may
+// use the same variables as the rest of the sketch, without disabling interrupts.
+// If the main loop was blocked for multiple ticks, the missed ticks are handled one per update().
+//
+// Handlers are registered by add(). The scheduler does not remove handlers; a handler that has
+// nothing to do should simply return.
+//
+// Some actions must happen at a precise moment, also if the main loop is busy (such as the end of
+// a relay pulse). For these, compare() arms a one-shot compare against the millisecond counter:
+// the ISR calls the CompareHandler (within the ISR!) once msCount reaches the given value.
+// There is a single compare; the handler may re-arm it for the next moment. If nothing is armed,
+// the ISR costs a single extra test.
+//
+//*****************************************************************************************************
+#pragma once
+#include <Arduino.h>
+
+#define TICK_MS              10    // Time between two ticks (in ms)
+#define MAX_TICK_HANDLERS     8    // Maximum number of handlers that can be registered
+
+typedef void (*TickHandler)(void);
+typedef void (*CompareHandler)(uint16_t now);
+
+class TickScheduler {
+  public:
+    void init(void);                          // Starts TCB1
+    bool add(TickHandler handler);            // Registers a handler. Returns false if the table is full
+    void update(void);                        // Should be called from main as often as possible
+    uint16_t ms(void);                        // Milliseconds since init (wraps after 65 seconds)
+    void compare(uint16_t atMs, CompareHandler handler);  // May also be called within the ISR
+    void isr(void);                           // Called from the TCB1 ISR
+
+    uint8_t ticks;                            // Number of ticks handled (wraps)
+
+  private:
+    volatile uint16_t msCount;                // Only written by the ISR
+    volatile uint8_t isrTicks;                // Only written by the ISR
+    uint8_t msInTick;                         // Only used by the ISR
+    volatile bool compareArmed;
+    uint16_t compareMs;
+    CompareHandler compareHandler;
+    uint8_t numHandlers;
+    TickHandler handlers[MAX_TICK_HANDLERS];
+};
+
+extern TickScheduler tickScheduler;           // Instantiated in core_Tick.cpp
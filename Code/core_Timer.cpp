@@ -5,6 +5,7 @@
 // History:   2022/07/19 AP Version 1.0
 //            2025/12/01 AP Version 1.1: Changed from library to be used within the sketch
 //                                       Filename changed
+//            2026/02/12 AP Version 1.2: uint32_t instead of unsigned long
 //
 // Purpose:   Timer class
 //
@@ -32,7 +33,7 @@
 #include <Arduino.h>
 #include "core_Timer.h"
 
-void DccTimer::setTime(unsigned long value) {
+void DccTimer::setTime(uint32_t value) {
   runTime = value;
   if (runTime > 0) {
     startTime = millis();
@@ -73,16 +74,16 @@ void DccTimer::stop() {
   notExpired = false;
 }
 
-unsigned long DccTimer::getRuntime() {
+uint32_t DccTimer::getRuntime() {
   return runTime;
 }
 
-unsigned long DccTimer::getElapsed() {
+uint32_t DccTimer::getElapsed() {
   if (running()) return ((millis() - startTime) + 1);
   else return runTime;
 }
 
-unsigned long DccTimer::getRemain() {
+uint32_t DccTimer::getRemain() {
   if (running()) return (runTime - (millis() - startTime));
   else return 0;
 }
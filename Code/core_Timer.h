@@ -5,6 +5,7 @@
 // History:   2022/07/19 AP Version 1.0
 //            2025/12/01 AP Version 1.1: Changed from library to be used within the sketch
 //                                       Filename changed
+//            2026/02/12 AP Version 1.2: uint32_t instead of unsigned long
 //
 // Purpose:   Timer class
 //
@@ -27,19 +28,19 @@
 
 class DccTimer {
   public:
-    unsigned long runTime = 0;
+    uint32_t runTime = 0;
 
-    void setTime(unsigned long value);
+    void setTime(uint32_t value);
     bool running();
     bool expired();
     void start();
     void restart();
     void stop();
-    unsigned long getRuntime();
-    unsigned long getElapsed();
-    unsigned long getRemain();
+    uint32_t getRuntime();
+    uint32_t getElapsed();
+    uint32_t getRemain();
 
   private:
     bool notExpired = false;             // can be set by stop() / expired()
-    unsigned long startTime = 0;
+    uint32_t startTime = 0;
 };
@@ -0,0 +1,101 @@
+//*****************************************************************************************************
+//
+// File:      AP_DCC_library.h
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//
+// Purpose:   Mock of AP_DCC_library, for the host build of the decoder sources
+//
+// The classes Dcc, Accessory, Loco and CvAccess have the same names, members and enumerations as
+// in AP_DCC_library, as far as they are used by the decoder sources. Instead of decoding a DCC
+// signal from TCB0, dcc.input() takes the next command from a queue that is filled by the host
+// program, via hostDcc (HostDcc.cpp). input() then fills accCmd, locoCmd or cvCmd and cmdType in
+// the same way as the real library would.
+//
+// dcc.detach() is only called by Processor::reboot(), just before it jumps to address 0. On the
+// host it throws HostReboot instead; the host program catches it and starts the sketch again.
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdint.h>
+
+struct HostReboot {};                   // Thrown by dcc.detach()
+
+class Dcc {
+  public:
+    enum CmdType_t {
+      IgnoreCmd,
+      ResetCmd,
+      SomeLocoMovesFlag,
+      SomeLocoSpeedFlag,
+      MyLocoSpeedCmd,
+      MyEmergencyStopCmd,
+      MyLocoF0F4Cmd,
+      MyLocoF5F8Cmd,
+      MyLocoF9F12Cmd,
+      MyLocoF13F20Cmd,
+      MyLocoF21F28Cmd,
+      AnyPomCmd,
+      MyPomCmd,
+      MyAccessoryCmd,
+      AnyAccessoryCmd,
+      SmCmd
+    };
+    CmdType_t cmdType;
+
+    void attach(uint8_t dccInputPin, uint8_t ackOutputPin);
+    void detach(void);
+    bool input(void);
+    void sendAck(void);
+};
+
+
+class Accessory {
+  public:
+    enum command_t {basic, extended};
+    command_t command;
+    uint16_t decoderAddress;            // 0..511
+    uint8_t device;                     // 1..4
+    uint16_t outputAddress;             // 1..2048
+    uint8_t position;                   // 0 = -, 1 = +
+    uint8_t activate;
+    uint8_t signalAspect;               // Extended accessory commands only
+    uint8_t myMaster;                   // Command station type (CV19)
+
+    void setMyAddress(uint16_t address);
+    uint16_t myAddress;
+};
+
+
+class Loco {
+  public:
+    uint8_t F0F4;                       // F1..F4 in bit 0..3, F0 (FL) in bit 4
+    uint8_t F5F8;
+    uint8_t F9F12;
+    uint8_t F13F20;
+    uint8_t F21F28;
+
+    void setMyAddress(uint16_t address);
+    uint16_t myAddress;
+};
+
+
+class CvAccess {
+  public:
+    enum operation_t {verifyByte, writeByte, bitManipulation};
+    operation_t operation;
+    uint16_t number;                    // 1..1024
+    uint8_t value;
+    bool writecmd;                      // Bit manipulation: write (true) or verify (false)
+    uint8_t bitposition;                // Bit manipulation: 0..7
+    uint8_t bitvalue;                   // Bit manipulation: 0 or 1
+
+    uint8_t writeBit(uint8_t currentValue);
+    bool verifyBit(uint8_t currentValue);
+};
+
+
+extern Dcc dcc;
+extern Accessory accCmd;
+extern Loco locoCmd;
+extern CvAccess cvCmd;
@@ -0,0 +1,163 @@
+//*****************************************************************************************************
+//
+// File:      Arduino.h
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/12 AP Version 1.1: millis() and micros() return uint32_t
+//
+// Purpose:   Mock of the Arduino / DxCore API, for the host build of the decoder sources
+//
+// Only the part of the API that is used by the decoder sources is provided. Time is virtual: it
+// is kept by hostIo (HostIo.cpp), and only advances if the host program asks for it (or if the
+// sources call delay()). Pins are numbered as port * 8 + bit; PIN_PA0 = 0, PIN_PF7 = 47.
+// This differs from DxCore, where not every port has 8 pins, but the sources only use the
+// PIN_Pxn names and the digitalPinTo...() macros, so the numbers themselves do not matter.
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "HostIo.h"
+
+#ifndef F_CPU
+#define F_CPU             24000000UL
+#endif
+#define E2END             0x1FF          // AVR DA: 512 bytes EEPROM
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH              1
+#define LOW               0
+#define INPUT             0
+#define OUTPUT            1
+#define INPUT_PULLUP      2
+
+#define DEC               10
+#define HEX               16
+#define OCT               8
+#define BIN               2
+
+// Ports, as returned by digitalPinToPort()
+#define PA                0
+#define PB                1
+#define PC                2
+#define PD                3
+#define PE                4
+#define PF                5
+
+#define HOST_PIN(port, bit)           ((port) * 8 + (bit))
+#define PIN_PA0 HOST_PIN(PA, 0)
+#define PIN_PA1 HOST_PIN(PA, 1)
+#define PIN_PA2 HOST_PIN(PA, 2)
+#define PIN_PA3 HOST_PIN(PA, 3)
+#define PIN_PA4 HOST_PIN(PA, 4)
+#define PIN_PA5 HOST_PIN(PA, 5)
+#define PIN_PA6 HOST_PIN(PA, 6)
+#define PIN_PA7 HOST_PIN(PA, 7)
+#define PIN_PB0 HOST_PIN(PB, 0)
+#define PIN_PB1 HOST_PIN(PB, 1)
+#define PIN_PB2 HOST_PIN(PB, 2)
+#define PIN_PB3 HOST_PIN(PB, 3)
+#define PIN_PB4 HOST_PIN(PB, 4)
+#define PIN_PB5 HOST_PIN(PB, 5)
+#define PIN_PC0 HOST_PIN(PC, 0)
+#define PIN_PC1 HOST_PIN(PC, 1)
+#define PIN_PC2 HOST_PIN(PC, 2)
+#define PIN_PC3 HOST_PIN(PC, 3)
+#define PIN_PC4 HOST_PIN(PC, 4)
+#define PIN_PC5 HOST_PIN(PC, 5)
+#define PIN_PC6 HOST_PIN(PC, 6)
+#define PIN_PC7 HOST_PIN(PC, 7)
+#define PIN_PD0 HOST_PIN(PD, 0)
+#define PIN_PD1 HOST_PIN(PD, 1)
+#define PIN_PD2 HOST_PIN(PD, 2)
+#define PIN_PD3 HOST_PIN(PD, 3)
+#define PIN_PD4 HOST_PIN(PD, 4)
+#define PIN_PD5 HOST_PIN(PD, 5)
+#define PIN_PD6 HOST_PIN(PD, 6)
+#define PIN_PD7 HOST_PIN(PD, 7)
+#define PIN_PE0 HOST_PIN(PE, 0)
+#define PIN_PE1 HOST_PIN(PE, 1)
+#define PIN_PE2 HOST_PIN(PE, 2)
+#define PIN_PE3 HOST_PIN(PE, 3)
+#define PIN_PF0 HOST_PIN(PF, 0)
+#define PIN_PF1 HOST_PIN(PF, 1)
+#define PIN_PF2 HOST_PIN(PF, 2)
+#define PIN_PF3 HOST_PIN(PF, 3)
+#define PIN_PF4 HOST_PIN(PF, 4)
+#define PIN_PF5 HOST_PIN(PF, 5)
+#define PIN_PF6 HOST_PIN(PF, 6)
+
+#define digitalPinToPort(pin)         ((uint8_t)((pin) >> 3))
+#define digitalPinToBitPosition(pin)  ((uint8_t)((pin) & 7))
+#define digitalPinToBitMask(pin)      ((uint8_t)(1 << ((pin) & 7)))
+#define digitalPinToPortStruct(pin)   (&hostIoSpace.port[(pin) >> 3])
+#define portInputRegister(port)       ((volatile uint8_t *)&hostIoSpace.vport[(port)].IN.value)
+#define portOutputRegister(port)      ((volatile uint8_t *)&hostIoSpace.vport[(port)].OUT.value)
+
+// Flash is ordinary memory on the host
+#define PROGMEM
+#define pgm_read_byte(addr)           (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)           (*(const uint16_t *)(addr))
+#define F(string)                     (string)
+
+#define bitRead(value, bit)           (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)            ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)          ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b)                        (1UL << (b))
+#define lowByte(w)                    ((uint8_t)((w) & 0xFF))
+#define highByte(w)                   ((uint8_t)((w) >> 8))
+
+#define interrupts()                  sei()
+#define noInterrupts()                cli()
+
+// Time (virtual, see HostIo.cpp). On the AVR unsigned long is 32 bit, on the host it is 64 bit;
+// uint32_t keeps the wrap-around after 49,7 days (millis) or 71,6 minutes (micros).
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Digital pins
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// DxCore: the sketch takes TCA0 over from analogWrite()
+void takeOverTCA0(void);
+
+
+//*****************************************************************************************************
+// Serial
+//*****************************************************************************************************
+// Output is collected in a buffer (HostSerial.cpp), and may also be echoed to stdout. Sending
+// takes virtual time, at the baud rate given to begin().
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud);
+    void swap(uint8_t state = 1) {(void)state;}
+    void flush(void);
+    int available(void) {return 0;}
+    int read(void) {return -1;}
+
+    size_t write(uint8_t c);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+    size_t println(void);
+    template <typename T> size_t println(T value) {size_t n = print(value); return n + println();}
+    template <typename T> size_t println(T value, int format) {size_t n = print(value, format); return n + println();}
+
+  private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,35 @@
+//*****************************************************************************************************
+//
+// File:      EEPROM.h
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: Write time
+//
+// Purpose:   Mock of the DxCore EEPROM library, for the host build of the decoder sources
+//
+// The EEPROM contents are held in RAM, and start erased (0xFF), as on a new chip. A host program
+// may preload or inspect the contents via `data`. Accesses outside the EEPROM read 0xFF and
+// are not written, but are counted, since on the AVR they would hit other memory.
+// Each byte written keeps the EEPROM busy for HOST_EEPROM_WRITE_US of virtual time (HostArduino.cpp).
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdint.h>
+#include "Arduino.h"
+
+class EEPROMClass {
+  public:
+    uint8_t data[E2END + 1];
+    uint32_t writes;                    // Number of bytes actually written (update() may skip)
+    uint32_t outOfRange;                // Accesses beyond E2END
+
+    EEPROMClass(void) {erase();}
+    void erase(void) {memset(data, 0xFF, sizeof(data)); writes = 0; outOfRange = 0;}
+
+    uint8_t read(int idx);
+    void write(int idx, uint8_t value);
+    void update(int idx, uint8_t value) {if (read(idx) != value) write(idx, value);}
+    uint16_t length(void) {return E2END + 1;}
+};
+
+extern EEPROMClass EEPROM;
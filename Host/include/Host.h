@@ -0,0 +1,420 @@
+//*****************************************************************************************************
+//
+// File:      Host.h
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: Peripheral timing, loop latency
+//            2026/02/12 AP Version 1.2: Scheduled events, idle() and skip() for long runs
+//            2026/02/13 AP Version 1.3: DCC packets and bit timings, for replay of recorded traffic
+//            2026/02/14 AP Version 1.4: hostBoard(), for programs that simulate many boards
+//            2026/02/16 AP Version 1.5: hostAccess, hardware accesses per call site and command
+//            2026/02/17 AP Version 1.6: hostTrace, waveforms as Value Change Dump
+//            2026/02/18 AP Version 1.7: hostBoard(): advance, analog inputs and the shortcut check
+//            2026/02/19 AP Version 1.8: Pin watch, hostBoard(): idle
+//            2026/02/20 AP Version 1.9: hostDcc.passQueued, for end-to-end latency
+//
+// Purpose:   Interface for host programs (benchmarks, simulators) that run the decoder sources
+//
+// The host build compiles Code/*.cpp unchanged, against the mocks in Host/include. These mocks
+// are controlled via the objects below:
+// - hostIo:      the virtual clock, external pin levels, analog inputs and pending interrupts
+// - hostDcc:     the queue of DCC commands or packets that dcc.input() will return
+// - hostSerial:  everything the sources printed
+// - hostSketch:  setup() and loop() of the decoder, as the main sketch would call them
+// - hostRam:     resets the RAM of the decoder sources, as after a reboot
+// - hostAccess:  counts the hardware accesses of the sources, per call site and per DCC command
+// - hostTrace:   records relays, LEDs, button and ADC inputs into a VCD file (GTKWave)
+//
+// A minimal host program:
+//   hostSketch.setup();
+//   hostDcc.accessory(5, 1, 1);          // Output address 5, position +, activate
+//   hostSketch.run(100);                 // Run for 100 ms virtual time
+//   uint16_t relays = hostSketch.relayPins();
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <deque>
+#include <map>
+#include <functional>
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "AP_DCC_library.h"
+
+
+//*****************************************************************************************************
+// Virtual clock, pins and interrupts (HostIo.cpp)
+//*****************************************************************************************************
+// The clock is charged for the peripherals the sources wait for. The time the sources themselves
+// need is not modelled, except for a fixed amount per loop() pass (HOST_LOOP_CYCLES).
+#define HOST_POLL_CYCLES        4          // One pass of a loop that polls a flag: LDS, SBRS, RJMP
+#define HOST_EEPROM_WRITE_US    11000      // EEPROM byte erase and write (AVR DA datasheet)
+#define HOST_PINS               (HOST_PORTS * 8)
+
+// Time only advances via advance(); the sources themselves advance it by calling delay(), and by
+// waiting for a peripheral or polling dcc.input(). A host program that must act while the sources
+// busy-wait (press a button, send a DCC command at a given moment) schedules that action with at().
+// Actions run from advance(), in order of time, before the ISRs due at that moment.
+// skip() is the fast forward for long soak runs: it moves the clock, and thus millis(), without
+// running timers or ISRs, as if the decoder were frozen. It should only be used while the decoder
+// is idle; TCB phases and counters of the sources do not move.
+typedef std::function<void(void)> HostAction;
+
+class hostIo_class {
+  public:
+    uint64_t cycles;                               // Virtual CPU clock (F_CPU cycles since power up)
+    uint64_t bootCycles;                           // cycles at the last reset; millis() counts from here
+
+    void reset(void);                              // Registers, clock and inputs as after power up
+    void reboot(void);                             // Registers only; time and external inputs go on
+    void advance(uint64_t numCycles);              // Runs timers, and calls their ISRs
+    void advanceUs(uint32_t us) {advance((uint64_t)us * (F_CPU / 1000000UL));}
+    void advanceMs(uint32_t ms) {advance((uint64_t)ms * (F_CPU / 1000UL));}
+    void skip(uint64_t ms);                        // Fast forward, see above
+    void skipToMillis(uint32_t ms);                // Skips until millis() returns ms
+    void at(uint64_t atCycles, HostAction action); // Runs action once the clock reaches atCycles
+    void atMs(uint64_t ms, HostAction action) {at(cycles + ms * (F_CPU / 1000UL), action);}
+    size_t scheduled(void) {return actions.size();}
+    uint64_t nextAction(void);                     // cycles of the first scheduled action, or UINT64_MAX
+
+    void setPin(uint8_t pin, bool level);          // External level of an input pin
+    bool pin(uint8_t pin);                         // Level of a pin (output or input)
+    void setAnalog(uint8_t muxpos, uint16_t value);// Result of an ADC conversion on this input
+    uint16_t analog(uint8_t muxpos) {return ain[muxpos & 0x3F];}
+    uint32_t conversions;                          // ADC conversions since reset
+    uint64_t tcbCycles(uint8_t tcb) {return tcbCount[tcb];}   // Cycles into the current period
+    uint64_t risen[HOST_PINS];                     // cycles at the last rising edge of a pin
+    uint64_t fallen[HOST_PINS];                    // cycles at the last falling edge of a pin
+    // Called after each write to a port (port: 0 = PORTA) or setPin(); cycles is then the time of
+    // the change. For host programs that follow outputs exactly, also while idle() skips loop()
+    void (*pinWatch)(void *context, uint8_t port);
+    void *pinWatchContext;
+
+    uint64_t adcCycles(void);                      // Duration of a conversion with the current settings
+    bool eepromBusy(void) {return cycles < eepromReady;}
+    void eepromWait(void);                         // As polling NVMCTRL.STATUS until EEBUSY clears
+    void eepromWrite(void);                        // Starts an erase / write; EEBUSY is set
+
+    // Called by hostIoWrite() / hostIoRead(); not meant for host programs
+    void portWritten(uint8_t port);
+    void adcStart(void);
+    void deliverInterrupts(void);
+
+  private:
+    uint8_t extIn[HOST_PORTS];                     // External levels (default: high, pull-ups)
+    uint8_t lastIn[HOST_PORTS];                    // For edge detection
+    uint8_t portPending;                           // bit n: PORTn interrupt pending
+    uint8_t tcbPending;                            // bit n: TCBn interrupt pending
+    uint64_t tcbCount[HOST_TCBS];                  // Cycles since the last TCB period
+    uint16_t ain[64];
+    bool adcBusy;
+    uint64_t adcReady;                             // cycles at which the conversion completes
+    uint64_t eepromReady;                          // cycles at which EEBUSY clears
+    std::multimap<uint64_t, HostAction> actions;   // Same time: in the order of at() calls
+    uint64_t tcbPeriod(uint8_t tcb);               // 0: not running in periodic interrupt mode
+    void adcComplete(void);
+    void senseEdges(uint8_t port);
+};
+
+extern hostIo_class hostIo;
+
+
+//*****************************************************************************************************
+// DCC command injection (HostDcc.cpp)
+//*****************************************************************************************************
+// Commands can be given in two forms:
+// - as a command (accessory(), pom(), ...): dcc.input() returns it, however busy the decoder was;
+// - as a packet (packet()): the bytes of a DCC packet, error detection byte included, as the ISR of
+//   AP_DCC_library delivers them once the end bit has been received. dcc.input() decodes the
+//   packet as the library does (NMRA S-9.2.1 / RCN-211..214). As in the library, there is room for
+//   HOST_DCC_PACKETS packets that input() has not taken yet; a packet that finds no room is dropped.
+// Accessory output addresses follow the Roco numbering (CV19 = 0): output 1 is decoder address 0.
+#define HOST_DCC_PACKETS        1          // Packets the ISR buffers for dcc.input()
+#define HOST_DCC_MAX_BYTES      6          // Longest packet, error detection byte included
+#define HOST_DCC_SM_MS          20         // Service mode: packets accepted after a reset packet
+
+struct HostDccCmd {
+  enum kind_t {ACC_BASIC, ACC_EXTENDED, LOCO_FUNCTIONS, POM, SM, PACKET} kind;
+  uint16_t address;                                // Output address (accessory) or loco address
+  uint8_t position;                                // Basic: position. Extended: aspect. Functions: group
+  uint8_t activate;                                // Basic: activate. Functions: function bits
+  uint16_t cvNumber;
+  uint8_t cvValue;
+  CvAccess::operation_t operation;
+  uint8_t length;                                  // Packet: number of bytes in data
+  uint8_t data[HOST_DCC_MAX_BYTES];
+  uint64_t queued;                                 // cycles at which the command was queued
+};
+
+class hostDcc_class {
+  public:
+    std::deque<HostDccCmd> queue;                  // Commands not yet taken by dcc.input()
+    bool attached;
+    uint32_t acks;                                 // Number of dcc.sendAck() calls
+    uint32_t inputs;                               // Number of commands returned by dcc.input()
+    // Packet statistics
+    uint32_t packets;                              // Packets delivered via packet()
+    uint32_t dropped;                              // No room in the packet buffer
+    uint32_t badChecksum;                          // Error detection byte did not match
+    uint32_t ignored;                              // Taken by input(), not returned (idle, errors, ...)
+    // Time from queueing until dcc.input() returned the command
+    uint64_t latencySum;
+    uint64_t latencyMax;
+    // cycles at which the last command that dcc.input() returned in this loop() pass was queued
+    // (for a packet: its end bit); 0 if none yet. Cleared at the start of each pass
+    uint64_t passQueued;
+
+    void reset(void);
+    void accessory(uint16_t outputAddress, uint8_t position, uint8_t activate = 1);
+    void extended(uint16_t outputAddress, uint8_t aspect);
+    // group: 0 = F0-F4, 1 = F5-F8, 2 = F9-F12, 3 = F13-F20, 4 = F21-F28; bits as in locoCmd
+    void functions(uint16_t locoAddress, uint8_t group, uint8_t bits);
+    // PoM is for this decoder if address is its loco address or its accessory decoder address
+    void pom(uint16_t address, uint16_t cvNumber, uint8_t value,
+             CvAccess::operation_t operation = CvAccess::writeByte);
+    void sm(uint16_t cvNumber, uint8_t value, CvAccess::operation_t operation = CvAccess::writeByte);
+    bool packet(const uint8_t *data, uint8_t length);   // false: dropped
+
+  private:
+    uint64_t resetPacket;                          // cycles of the last reset packet (service mode)
+    void push(HostDccCmd &cmd);
+    bool decode(const HostDccCmd &cmd);            // Packet to accCmd / locoCmd / cvCmd and cmdType
+    friend class Dcc;
+};
+
+// The DCC signal as the ISR of AP_DCC_library sees it: the time between two edges (a half bit)
+// is 52..64 us for a one and 90..10000 us for a zero. Two equal halves form a bit; a half that
+// differs from the one before starts a new bit, which brings the decoder in phase at the first
+// zero after the preamble. A packet is a preamble of at least 10 ones, followed by bytes that are
+// each preceded by a zero; a one ends the packet.
+#define HOST_DCC_PREAMBLE       10         // Minimum number of preamble bits a decoder accepts
+
+class HostDccBits {
+  public:
+    uint8_t data[HOST_DCC_MAX_BYTES];              // The packet, once halfBit() returned true
+    uint8_t length;
+    uint32_t errors;                               // Half bits out of range, packets too long
+
+    void reset(void);
+    bool halfBit(uint32_t us);                     // true: a packet is complete
+
+  private:
+    int8_t lastHalf;                               // -1: none; else the bit value of the first half
+    bool inPacket;
+    uint8_t ones;                                  // Preamble bits received
+    uint8_t numBits;                               // Bits of the current byte; 8: expect separator
+    uint8_t value;
+    bool addBit(uint8_t b);                        // true: the end bit of a packet
+};
+
+extern hostDcc_class hostDcc;
+
+
+//*****************************************************************************************************
+// Serial output (HostSerial.cpp)
+//*****************************************************************************************************
+// Serial.write() puts a byte in the transmit buffer; the USART sends it 10 bit times after the
+// previous one. If the buffer is full, write() waits (and the clock advances) until there is room.
+#define HOST_SERIAL_BUFFER      64         // DxCore transmit buffer
+
+class hostSerial_class {
+  public:
+    std::string output;                            // Everything printed since the last clear()
+    bool echo;                                     // Also write to stdout
+    uint32_t baud;                                 // Set by Serial.begin(); 0: sending takes no time
+    uint64_t waitCycles;                           // Time write() spent waiting for buffer room
+    void clear(void) {output.clear();}
+    void reset(void) {baud = 0; waitCycles = 0; txReady = 0;}   // Power up; output is kept
+    void transmit(void);                           // Charges the time for one byte
+    void flush(void);                              // Waits until the last byte has been sent
+
+  private:
+    uint64_t txReady;                              // cycles at which the last buffered byte is sent
+    uint64_t byteCycles(void) {return (uint64_t)F_CPU * 10 / baud;}
+};
+
+extern hostSerial_class hostSerial;
+
+
+//*****************************************************************************************************
+// RAM of the decoder sources (HostRam.cpp)
+//*****************************************************************************************************
+// On the AVR, a reboot (jmp 0) runs the C startup code again, which re-initialises .data and
+// clears .bss. On the host, snapshot() saves the writable data segment of the shared library that
+// holds the decoder sources and the mocks; restore() copies it back. The mock objects that model
+// hardware or the host side (registers, EEPROM, virtual clock, DCC queue, serial output, ...) are
+// kept, since a reboot does not change them.
+#define HOST_RAM_KEEP     16                       // Maximum number of objects that are kept
+
+class hostRam_class {
+  public:
+    size_t size;                                   // Bytes in the snapshot. 0: no snapshot yet
+    void snapshot(void);
+    void restore(void);
+    void keep(void *object, size_t objectSize);    // Not restored
+
+  private:
+    uint8_t *start;
+    uint8_t *copy;
+    uint8_t numKeep;
+    uint8_t *keepObject[HOST_RAM_KEEP];
+    size_t keepSize[HOST_RAM_KEEP];
+};
+
+extern hostRam_class hostRam;
+
+
+//*****************************************************************************************************
+// Hardware access accounting (HostAccess.cpp)
+//*****************************************************************************************************
+// Much of the time of the decoder goes to accesses that look cheap in the sources: an EEPROM
+// read in CvValues::read(), a digitalRead() or millis() call, a byte printed to Serial. While
+// enabled, the mocks record each such access with its call site: the return address into the
+// sources. siteName() turns a site into the name of the function; static functions are not in the
+// symbol table of the library and show as the exported function before them. The offset it adds
+// is relative to the library file, for addr2line -e libtmcdecoder.so.
+// A command window starts when dcc.input() returns a command, and ends with the loop() pass that
+// took it: the accesses the sources need to process that one command. Work the sources postpone to
+// later passes (a relay pulse, an EEPROM write in progress) is not part of the window.
+enum HostAccessType {
+  ACCESS_EEPROM_READ, ACCESS_EEPROM_WRITE, ACCESS_DIGITAL_READ, ACCESS_DIGITAL_WRITE,
+  ACCESS_MILLIS, ACCESS_MICROS, ACCESS_SERIAL_BYTE, ACCESS_ADC_CONVERSION,
+  HOST_ACCESS_TYPES
+};
+
+typedef std::pair<const void *, uint8_t> HostAccessSite;        // Return address, HostAccessType
+
+class hostAccess_class {
+  public:
+    bool enabled;                                  // Off after power up: recording costs time
+    uint32_t count[HOST_ACCESS_TYPES];             // Since clear()
+    std::map<HostAccessSite, uint32_t> sites;      // Since clear()
+    // The last command window
+    bool inCommand;                                // The window is still open
+    Dcc::CmdType_t cmdType;
+    uint32_t cmdCount[HOST_ACCESS_TYPES];
+    std::map<HostAccessSite, uint32_t> cmdSites;
+    uint32_t commands;                             // Windows since clear()
+
+    void clear(void);
+    void record(HostAccessType type, const void *site) {if (enabled) add(type, site);}
+    void beginCommand(Dcc::CmdType_t type);        // Called by dcc.input()
+    void endCommand(void);                         // Called at the end of hostSketch.loop()
+    static std::string siteName(const void *site);
+    static const char *typeName(uint8_t type);
+
+  private:
+    void add(uint8_t type, const void *site);
+};
+
+extern hostAccess_class hostAccess;
+
+// The call site of the mock function this is used in
+#define HOST_ACCESS_SITE   __builtin_return_address(0)
+
+
+//*****************************************************************************************************
+// Waveforms (HostTrace.cpp)
+//*****************************************************************************************************
+// While a trace is open, every change of the signals below is recorded with its time on the
+// virtual clock, and written as a Value Change Dump (IEEE 1364), with a resolution of 1 ns:
+// - relay1..relay16        the RELAYn pins
+// - led_dcc, led_acc       PWM duty (0..255) while the TCA0 compare output is enabled, else 0 / 255
+// - led_prog, led_error    the pins
+// - button                 the pin (low = pressed)
+// - adc_relay1..16         the input of the ADC channel of each relay (setAnalog())
+// The pins are compared after each port write (hostIo.portWritten()) and TCA0 write; the ADC
+// inputs when the host program sets them. Events go into a buffer of HOST_TRACE_EVENTS that is
+// allocated by open(); a full buffer is written to the file at once, so that recording costs no
+// memory allocation and little time, however long the simulation runs.
+#define HOST_TRACE_EVENTS  65536
+
+struct HostTraceEvent {
+  uint64_t cycles;
+  uint16_t value;
+  uint8_t signal;
+};
+
+class hostTrace_class {
+  public:
+    uint64_t events;                               // Recorded since open()
+    bool open(const char *fileName, size_t bufferEvents = HOST_TRACE_EVENTS);  // false: no file
+    void close(void);                              // Writes the events still in the buffer
+    bool isOpen(void) {return file != NULL;}
+
+    // Called by hostIo; not meant for host programs
+    void pinsChanged(void) {if (file) comparePins();}
+    void analogChanged(uint8_t muxpos, uint16_t value) {if (file) compareAnalog(muxpos, value);}
+
+  private:
+    FILE *file;
+    HostTraceEvent *buffer;
+    size_t size;
+    size_t used;
+    uint64_t latest;                               // Time of the last event
+    uint64_t offset;                               // Added to hostIo.cycles, which setup() resets
+    uint64_t written;                              // Time of the last #time line in the file
+    uint16_t last[64];                             // Last recorded value per signal
+    void comparePins(void);
+    void compareAnalog(uint8_t muxpos, uint16_t value);
+    void add(uint8_t signal, uint16_t value);
+    void flush(void);
+};
+
+extern hostTrace_class hostTrace;
+
+
+//*****************************************************************************************************
+// The decoder sketch (HostSketch.cpp)
+//*****************************************************************************************************
+#define HOST_LOOP_CYCLES   240                     // Virtual time per loop() pass (10 us)
+
+#define HOST_IDLE_MS       10                      // One tick of the tick scheduler (TICK_MS)
+
+class hostSketch_class {
+  public:
+    uint32_t reboots;                              // Number of Processor::reboot() calls
+    uint64_t loopCycles;                           // Duration of the last loop() pass, ISRs included
+    uint64_t maxLoopCycles;                        // Worst case since setup()
+
+    void setup(void);                              // Also resets the mocks, but not the EEPROM
+    void loop(void);                               // One pass; a reboot runs setup() again
+    void run(uint32_t ms);                         // loop() for ms virtual milliseconds
+    // As run(), but while no DCC commands are queued loop() runs only once per HOST_IDLE_MS, and
+    // directly after each scheduled action. All timed behaviour of the sources uses ticks or
+    // millis(), so this only delays the reaction to pin changes, by at most HOST_IDLE_MS
+    void idle(uint64_t ms);
+    uint16_t relayPins(void);                      // bit n: level of the RELAYn+1 pin
+};
+
+extern hostSketch_class hostSketch;
+
+
+//*****************************************************************************************************
+// Entry points for multi-board programs (HostBoard.cpp)
+//*****************************************************************************************************
+// The sources keep their state in globals, so each simulated board needs its own copy of this
+// library. A program that simulates many boards does not link the library, but loads a copy of
+// the file per thread (dlopen() of a copy with another name, RTLD_LOCAL | RTLD_DEEPBIND), and runs
+// its boards one after the other on that copy. It must call such a copy only via the table that
+// hostBoard() returns: a direct call of a member function would always go to the same copy.
+// Data members (such as io->cycles or dcc->dropped) may be read via the pointers in the table.
+struct HostBoard {
+  hostIo_class *io;
+  hostDcc_class *dcc;
+  hostSketch_class *sketch;
+  uint8_t *eeprom;                                 // E2END + 1 bytes; setup() keeps them
+  void (*setup)(void);
+  void (*loop)(void);
+  void (*packet)(uint64_t atCycles, const uint8_t *data, uint8_t length);  // hostDcc.packet() at
+  uint16_t (*relayPins)(void);
+  void (*advance)(uint64_t numCycles);             // hostIo.advance()
+  void (*setAnalog)(uint8_t muxpos, uint16_t value);
+  // relays.adc.shortcut() with maxValue; result: the conversion result it compared (ADC0.RES)
+  bool (*shortcut)(uint8_t muxpos, uint8_t maxValue, uint16_t *result);
+  void (*idle)(uint64_t ms);                       // hostSketch.idle()
+};
+
+extern "C" const HostBoard *hostBoard(void);
@@ -0,0 +1,354 @@
+//*****************************************************************************************************
+//
+// File:      HostIo.h
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: NVMCTRL, all ADC prescaler values
+//
+// Purpose:   Mock of the AVR DA I/O registers, for the host build of the decoder sources
+//
+// The decoder sources access the peripherals directly: PORTA.OUTSET = ..., ADC0.COMMAND = ...,
+// (&VPORTA)[n].OUT |= ... etc. To compile and run these sources unchanged on a host, all
+// registers used by them are declared here, with the same names and the same layout as in the
+// avr-libc / DxCore headers. All registers live in a single structure (hostIoSpace), which thus
+// plays the role of the AVR I/O address space.
+//
+// Registers with side effects are of type Reg8 / Reg16. A Reg8 stores its value, but every write
+// (and read) goes through hostIoWrite() / hostIoRead(). These functions determine, from the
+// address of the register within hostIoSpace, which peripheral is addressed, and let its model
+// (HostIo.cpp) react. Examples: OUTSET changes OUT and IN, a write of STCONV to ADC0.COMMAND
+// starts a conversion, a write of 1 to an INTFLAGS bit clears that bit.
+// Registers without side effects (such as PINnCTRL) are plain volatile uint8_t, since the sources
+// also take their address as `volatile uint8_t *`.
+// Reading via such a raw pointer (portInputRegister()) bypasses hostIoRead(); the models therefore
+// always keep the stored value of a register up to date.
+//
+// Only registers and bit masks used by the decoder sources are defined. Values of the bit masks
+// and group configurations are taken from the AVR DA datasheet.
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdint.h>
+
+struct Reg8;
+struct Reg16;
+void hostIoWrite(Reg8 *reg, uint8_t value);
+void hostIoWrite(Reg16 *reg, uint16_t value);
+uint8_t hostIoRead(Reg8 *reg);
+uint16_t hostIoRead(Reg16 *reg);
+
+struct Reg8 {
+  uint8_t value;
+  operator uint8_t() {return hostIoRead(this);}
+  Reg8 &operator=(uint8_t v) {hostIoWrite(this, v); return *this;}
+  Reg8 &operator=(Reg8 &other) {hostIoWrite(this, (uint8_t)other); return *this;}
+  Reg8 &operator|=(uint8_t v) {hostIoWrite(this, hostIoRead(this) | v); return *this;}
+  Reg8 &operator&=(uint8_t v) {hostIoWrite(this, hostIoRead(this) & v); return *this;}
+  Reg8 &operator^=(uint8_t v) {hostIoWrite(this, hostIoRead(this) ^ v); return *this;}
+};
+
+struct Reg16 {
+  uint16_t value;
+  operator uint16_t() {return hostIoRead(this);}
+  Reg16 &operator=(uint16_t v) {hostIoWrite(this, v); return *this;}
+};
+
+
+//*****************************************************************************************************
+// Peripheral layouts
+//*****************************************************************************************************
+typedef struct VPORT_struct {
+  Reg8 DIR;
+  Reg8 OUT;
+  Reg8 IN;
+  Reg8 INTFLAGS;
+} VPORT_t;
+
+typedef struct PORT_struct {
+  Reg8 DIR;
+  Reg8 DIRSET;
+  Reg8 DIRCLR;
+  Reg8 DIRTGL;
+  Reg8 OUT;
+  Reg8 OUTSET;
+  Reg8 OUTCLR;
+  Reg8 OUTTGL;
+  Reg8 IN;
+  Reg8 INTFLAGS;
+  volatile uint8_t PORTCTRL;
+  Reg8 PINCONFIG;
+  Reg8 PINCTRLUPD;
+  Reg8 PINCTRLSET;
+  Reg8 PINCTRLCLR;
+  volatile uint8_t reserved_0x0F;
+  volatile uint8_t PIN0CTRL;
+  volatile uint8_t PIN1CTRL;
+  volatile uint8_t PIN2CTRL;
+  volatile uint8_t PIN3CTRL;
+  volatile uint8_t PIN4CTRL;
+  volatile uint8_t PIN5CTRL;
+  volatile uint8_t PIN6CTRL;
+  volatile uint8_t PIN7CTRL;
+  volatile uint8_t reserved_0x18[8];
+} PORT_t;
+
+typedef struct ADC_struct {
+  Reg8 CTRLA;
+  Reg8 CTRLB;
+  Reg8 CTRLC;
+  Reg8 CTRLD;
+  Reg8 CTRLE;
+  Reg8 SAMPCTRL;
+  Reg8 MUXPOS;
+  Reg8 MUXNEG;
+  Reg8 COMMAND;
+  Reg8 EVCTRL;
+  Reg8 INTCTRL;
+  Reg8 INTFLAGS;
+  Reg8 DBGCTRL;
+  Reg8 TEMP;
+  Reg16 RES;
+  Reg16 WINLT;
+  Reg16 WINHT;
+} ADC_t;
+
+typedef struct TCB_struct {
+  Reg8 CTRLA;
+  Reg8 CTRLB;
+  Reg8 EVCTRL;
+  Reg8 INTCTRL;
+  Reg8 INTFLAGS;
+  Reg8 STATUS;
+  Reg8 DBGCTRL;
+  Reg8 TEMP;
+  Reg16 CNT;
+  Reg16 CCMP;
+} TCB_t;
+
+typedef struct TCA_SPLIT_struct {
+  Reg8 CTRLA;
+  Reg8 CTRLB;
+  Reg8 CTRLC;
+  Reg8 CTRLD;
+  Reg8 CTRLECLR;
+  Reg8 CTRLESET;
+  Reg8 INTCTRL;
+  Reg8 INTFLAGS;
+  Reg8 LPER;
+  Reg8 HPER;
+  Reg8 LCMP0;
+  Reg8 HCMP0;
+  Reg8 LCMP1;
+  Reg8 HCMP1;
+  Reg8 LCMP2;
+  Reg8 HCMP2;
+} TCA_SPLIT_t;
+
+typedef struct TCA_struct {
+  TCA_SPLIT_t SPLIT;                    // Only split mode is used by the decoder
+} TCA_t;
+
+typedef struct VREF_struct {
+  Reg8 ADC0REF;
+  Reg8 DAC0REF;
+  Reg8 ACREF;
+} VREF_t;
+
+typedef struct NVMCTRL_struct {
+  Reg8 CTRLA;
+  Reg8 CTRLB;
+  Reg8 STATUS;
+  Reg8 INTCTRL;
+  Reg8 INTFLAGS;
+  Reg8 reserved;
+  Reg16 DATA;
+  Reg16 ADDR;                           // ADDR0..1; ADDR2 is not needed for the EEPROM
+} NVMCTRL_t;
+
+typedef struct PORTMUX_struct {
+  Reg8 EVSYSROUTEA;
+  Reg8 CCLROUTEA;
+  Reg8 USARTROUTEA;
+  Reg8 USARTROUTEB;
+  Reg8 SPIROUTEA;
+  Reg8 TWIROUTEA;
+  Reg8 TCAROUTEA;
+  Reg8 TCBROUTEA;
+} PORTMUX_t;
+
+
+//*****************************************************************************************************
+// The I/O space
+//*****************************************************************************************************
+#define HOST_PORTS   6                  // PORTA .. PORTF
+#define HOST_TCBS    4                  // TCB0 .. TCB3
+
+struct HostIoSpace {
+  VPORT_t vport[HOST_PORTS];            // Must be the first: (&VPORTA)[n] is VPORT n
+  PORT_t port[HOST_PORTS];
+  ADC_t adc0;
+  TCA_t tca0;
+  TCB_t tcb[HOST_TCBS];
+  VREF_t vref;
+  NVMCTRL_t nvmctrl;
+  PORTMUX_t portmux;
+};
+
+extern HostIoSpace hostIoSpace;         // Instantiated in HostIo.cpp
+
+#define VPORTA    (hostIoSpace.vport[0])
+#define VPORTB    (hostIoSpace.vport[1])
+#define VPORTC    (hostIoSpace.vport[2])
+#define VPORTD    (hostIoSpace.vport[3])
+#define VPORTE    (hostIoSpace.vport[4])
+#define VPORTF    (hostIoSpace.vport[5])
+#define PORTA     (hostIoSpace.port[0])
+#define PORTB     (hostIoSpace.port[1])
+#define PORTC     (hostIoSpace.port[2])
+#define PORTD     (hostIoSpace.port[3])
+#define PORTE     (hostIoSpace.port[4])
+#define PORTF     (hostIoSpace.port[5])
+#define ADC0      (hostIoSpace.adc0)
+#define TCA0      (hostIoSpace.tca0)
+#define TCB0      (hostIoSpace.tcb[0])
+#define TCB1      (hostIoSpace.tcb[1])
+#define TCB2      (hostIoSpace.tcb[2])
+#define TCB3      (hostIoSpace.tcb[3])
+#define VREF      (hostIoSpace.vref)
+#define NVMCTRL   (hostIoSpace.nvmctrl)
+#define PORTMUX   (hostIoSpace.portmux)
+
+
+//*****************************************************************************************************
+// Bit masks and group configurations
+//*****************************************************************************************************
+#define PIN0_bm                     0x01
+#define PIN1_bm                     0x02
+#define PIN2_bm                     0x04
+#define PIN3_bm                     0x08
+#define PIN4_bm                     0x10
+#define PIN5_bm                     0x20
+#define PIN6_bm                     0x40
+#define PIN7_bm                     0x80
+
+// PORT
+#define PORT_ISC_gm                 0x07
+#define PORT_ISC_INTDISABLE_gc      0x00
+#define PORT_ISC_BOTHEDGES_gc       0x01
+#define PORT_ISC_RISING_gc          0x02
+#define PORT_ISC_FALLING_gc         0x03
+#define PORT_ISC_INPUT_DISABLE_gc   0x04
+#define PORT_ISC_LEVEL_gc           0x05
+#define PORT_PULLUPEN_bm            0x08
+#define PORT_INVEN_bm               0x80
+
+// ADC
+#define ADC_ENABLE_bm               0x01
+#define ADC_RESSEL_gm               0x0C
+#define ADC_RESSEL_12BIT_gc         0x00
+#define ADC_RESSEL_10BIT_gc         0x04
+#define ADC_SAMPNUM_gm              0x07
+#define ADC_SAMPNUM_NONE_gc         0x00
+#define ADC_SAMPNUM_ACC2_gc         0x01
+#define ADC_SAMPNUM_ACC4_gc         0x02
+#define ADC_SAMPNUM_ACC8_gc         0x03
+#define ADC_SAMPNUM_ACC16_gc        0x04
+#define ADC_SAMPNUM_ACC32_gc        0x05
+#define ADC_SAMPNUM_ACC64_gc        0x06
+#define ADC_PRESC_gm                0x0F
+#define ADC_PRESC_DIV2_gc           0x00
+#define ADC_PRESC_DIV4_gc           0x01
+#define ADC_PRESC_DIV6_gc           0x02
+#define ADC_PRESC_DIV8_gc           0x03
+#define ADC_PRESC_DIV10_gc          0x04
+#define ADC_PRESC_DIV12_gc          0x05
+#define ADC_PRESC_DIV14_gc          0x06
+#define ADC_PRESC_DIV16_gc          0x07
+#define ADC_PRESC_DIV20_gc          0x08
+#define ADC_PRESC_DIV24_gc          0x09
+#define ADC_PRESC_DIV28_gc          0x0A
+#define ADC_PRESC_DIV32_gc          0x0B
+#define ADC_PRESC_DIV40_gc          0x0C
+#define ADC_PRESC_DIV48_gc          0x0D
+#define ADC_PRESC_DIV56_gc          0x0E
+#define ADC_PRESC_DIV64_gc          0x0F
+#define ADC_STCONV_bm               0x01
+#define ADC_RESRDY_bm               0x01
+#define ADC_MUXPOS_AIN0_gc          0x00
+#define ADC_MUXPOS_AIN1_gc          0x01
+#define ADC_MUXPOS_AIN2_gc          0x02
+#define ADC_MUXPOS_AIN3_gc          0x03
+#define ADC_MUXPOS_AIN4_gc          0x04
+#define ADC_MUXPOS_AIN5_gc          0x05
+#define ADC_MUXPOS_AIN6_gc          0x06
+#define ADC_MUXPOS_AIN7_gc          0x07
+#define ADC_MUXPOS_AIN8_gc          0x08
+#define ADC_MUXPOS_AIN9_gc          0x09
+#define ADC_MUXPOS_AIN10_gc         0x0A
+#define ADC_MUXPOS_AIN11_gc         0x0B
+#define ADC_MUXPOS_AIN16_gc         0x10
+#define ADC_MUXPOS_AIN17_gc         0x11
+#define ADC_MUXPOS_AIN18_gc         0x12
+#define ADC_MUXPOS_AIN19_gc         0x13
+
+// VREF
+#define VREF_REFSEL_1V024_gc        0x00
+#define VREF_REFSEL_2V048_gc        0x01
+#define VREF_REFSEL_4V096_gc        0x02
+#define VREF_REFSEL_2V500_gc        0x03
+#define VREF_REFSEL_VDD_gc          0x05
+
+// NVMCTRL
+#define NVMCTRL_CMD_gm              0x7F
+#define NVMCTRL_CMD_NONE_gc         0x00
+#define NVMCTRL_CMD_EEERWR_gc       0x13
+#define NVMCTRL_FBUSY_bm            0x01
+#define NVMCTRL_EEBUSY_bm           0x02
+
+// TCB
+#define TCB_ENABLE_bm               0x01
+#define TCB_CLKSEL_gm               0x0E
+#define TCB_CLKSEL_DIV1_gc          0x00
+#define TCB_CLKSEL_DIV2_gc          0x02
+#define TCB_CNTMODE_gm              0x07
+#define TCB_CNTMODE_INT_gc          0x00
+#define TCB_CAPT_bm                 0x01
+
+// TCA (split mode)
+#define TCA_SPLIT_ENABLE_bm         0x01
+#define TCA_SPLIT_CLKSEL_gm         0x0E
+#define TCA_SPLIT_CLKSEL_DIV64_gc   0x0A
+#define TCA_SPLIT_SPLITM_bm         0x01
+#define TCA_SPLIT_HCMP0EN_bm        0x10
+#define TCA_SPLIT_HCMP1EN_bm        0x20
+#define TCA_SPLIT_HCMP2EN_bm        0x40
+
+// PORTMUX
+#define PORTMUX_TCA0_gm             0x07
+#define PORTMUX_TCA0_PORTA_gc       0x00
+#define PORTMUX_TCA0_PORTF_gc       0x05
+
+
+//*****************************************************************************************************
+// Interrupts
+//*****************************************************************************************************
+// An ISR in the sources becomes an ordinary C function, which the models call when the interrupt
+// fires. The status register only holds the global interrupt flag (bit 7).
+#define ISR(vector, ...)  extern "C" void vector(void)
+#define SREG_I            0x80
+extern uint8_t SREG;                    // Instantiated in HostIo.cpp
+#define sei()             (SREG |= SREG_I)
+#define cli()             (SREG &= (uint8_t)~SREG_I)
+
+extern "C" {
+  void PORTA_PORT_vect(void);
+  void PORTB_PORT_vect(void);
+  void PORTC_PORT_vect(void);
+  void PORTD_PORT_vect(void);
+  void PORTE_PORT_vect(void);
+  void PORTF_PORT_vect(void);
+  void TCB0_INT_vect(void);
+  void TCB1_INT_vect(void);
+  void TCB2_INT_vect(void);
+  void TCB3_INT_vect(void);
+}
@@ -0,0 +1,84 @@
+//*****************************************************************************************************
+//
+// File:      HostAccess.cpp
+// Author:    Aiko Pras
+// History:   2026/02/16 AP Version 1.0
+//
+// Purpose:   Counts the hardware accesses of the decoder sources, per call site and per command
+//
+// The mocks call hostAccess.record() with HOST_ACCESS_SITE, the address their caller returns to.
+// Sites are stored as addresses, and only turned into names when a host program asks for them.
+//
+//*****************************************************************************************************
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Host.h"
+
+hostAccess_class hostAccess;
+
+static const char *typeNames[HOST_ACCESS_TYPES] = {
+  "EEPROM read", "EEPROM write", "digitalRead", "digitalWrite",
+  "millis", "micros", "Serial byte", "ADC conversion"
+};
+
+
+void hostAccess_class::clear(void) {
+  for (uint8_t i = 0; i < HOST_ACCESS_TYPES; i++) {
+    count[i] = 0;
+    cmdCount[i] = 0;
+  }
+  sites.clear();
+  cmdSites.clear();
+  inCommand = false;
+  cmdType = Dcc::IgnoreCmd;
+  commands = 0;
+}
+
+
+void hostAccess_class::add(uint8_t type, const void *site) {
+  count[type]++;
+  sites[HostAccessSite(site, type)]++;
+  if (inCommand) {
+    cmdCount[type]++;
+    cmdSites[HostAccessSite(site, type)]++;
+  }
+}
+
+
+void hostAccess_class::beginCommand(Dcc::CmdType_t type) {
+  if (!enabled) return;
+  for (uint8_t i = 0; i < HOST_ACCESS_TYPES; i++) cmdCount[i] = 0;
+  cmdSites.clear();
+  cmdType = type;
+  inCommand = true;
+  commands++;
+}
+
+
+void hostAccess_class::endCommand(void) {
+  inCommand = false;
+}
+
+
+std::string hostAccess_class::siteName(const void *site) {
+  Dl_info info;
+  if (!dladdr(site, &info) || (info.dli_fname == NULL)) return "?";
+  char text[64];
+  snprintf(text, sizeof(text), " [0x%lx]", (unsigned long)((uintptr_t)site - (uintptr_t)info.dli_fbase));
+  if (info.dli_sname == NULL) return std::string("?") + text;
+  int status;
+  char *demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+  std::string name = (status == 0) ? demangled : info.dli_sname;
+  free(demangled);
+  return name + text;
+}
+
+
+const char *hostAccess_class::typeName(uint8_t type) {
+  return (type < HOST_ACCESS_TYPES) ? typeNames[type] : "?";
+}
@@ -0,0 +1,100 @@
+//*****************************************************************************************************
+//
+// File:      HostArduino.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: EEPROM write time
+//            2026/02/16 AP Version 1.2: Access accounting (hostAccess)
+//
+// Purpose:   Mock of the Arduino / DxCore functions: time, digital pins and EEPROM
+//
+// millis() and micros() are derived from the virtual clock, and restart at a reboot. delay()
+// advances that clock, and thus runs the timer ISRs, as a busy-waiting delay() on the AVR would.
+// Like on the AVR, millis() and micros() are 32 bit counters, and wrap.
+//
+//*****************************************************************************************************
+#include "Host.h"
+
+EEPROMClass EEPROM;
+
+
+uint32_t millis(void) {
+  hostAccess.record(ACCESS_MILLIS, HOST_ACCESS_SITE);
+  return (uint32_t)((hostIo.cycles - hostIo.bootCycles) / (F_CPU / 1000UL));
+}
+
+
+uint32_t micros(void) {
+  hostAccess.record(ACCESS_MICROS, HOST_ACCESS_SITE);
+  return (uint32_t)((hostIo.cycles - hostIo.bootCycles) / (F_CPU / 1000000UL));
+}
+
+
+void delay(unsigned long ms) {
+  hostIo.advanceMs(ms);
+}
+
+
+void delayMicroseconds(unsigned int us) {
+  hostIo.advanceUs(us);
+}
+
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  PORT_t &port = *digitalPinToPortStruct(pin);
+  volatile uint8_t *pinCtrl = &port.PIN0CTRL + digitalPinToBitPosition(pin);
+  if (mode == OUTPUT) port.DIRSET = digitalPinToBitMask(pin);
+  else {
+    port.DIRCLR = digitalPinToBitMask(pin);
+    if (mode == INPUT_PULLUP) *pinCtrl |= PORT_PULLUPEN_bm;
+    else *pinCtrl &= ~PORT_PULLUPEN_bm;
+  }
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  hostAccess.record(ACCESS_DIGITAL_WRITE, HOST_ACCESS_SITE);
+  PORT_t &port = *digitalPinToPortStruct(pin);
+  if (value) port.OUTSET = digitalPinToBitMask(pin);
+  else port.OUTCLR = digitalPinToBitMask(pin);
+}
+
+
+int digitalRead(uint8_t pin) {
+  hostAccess.record(ACCESS_DIGITAL_READ, HOST_ACCESS_SITE);
+  return (hostIoSpace.port[digitalPinToPort(pin)].IN & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+
+void takeOverTCA0(void) {
+}
+
+
+//*****************************************************************************************************
+// EEPROM
+//*****************************************************************************************************
+// As the DxCore library, write() waits until a previous write has completed, and then starts the
+// erase / write of the byte without waiting for it. A read also waits: the CPU is stalled while it
+// accesses the EEPROM during a write.
+uint8_t EEPROMClass::read(int idx) {
+  hostAccess.record(ACCESS_EEPROM_READ, HOST_ACCESS_SITE);
+  if ((idx < 0) || (idx > E2END)) {
+    outOfRange++;
+    return 0xFF;
+  }
+  hostIo.eepromWait();
+  return data[idx];
+}
+
+
+void EEPROMClass::write(int idx, uint8_t value) {
+  hostAccess.record(ACCESS_EEPROM_WRITE, HOST_ACCESS_SITE);
+  if ((idx < 0) || (idx > E2END)) {
+    outOfRange++;
+    return;
+  }
+  hostIo.eepromWait();
+  data[idx] = value;
+  writes++;
+  hostIo.eepromWrite();
+}
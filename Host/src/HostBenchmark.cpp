@@ -0,0 +1,32 @@
+//*****************************************************************************************************
+//
+// File:      HostBenchmark.cpp
+// Author:    Aiko Pras
+// History:   2026/02/15 AP Version 1.0
+//
+// Purpose:   Host backend of the benchmark suite (Code/Benchmark.cpp): a nanosecond clock
+//
+// std::chrono::steady_clock is used rather than the time stamp counter: on current processors
+// the TSC runs at a fixed rate that is not the core clock, so it gives no cycles either, and
+// steady_clock is portable. The virtual clock (hostIo.cycles) is not used, since it only counts
+// the time the sources wait for peripherals.
+//
+//*****************************************************************************************************
+#include <chrono>
+#include "Benchmark.h"
+
+const char benchBackend[] = "host";
+const char benchUnit[] = "ns";
+
+static std::chrono::steady_clock::time_point origin;
+
+
+void benchClockInit(void) {
+  origin = std::chrono::steady_clock::now();
+}
+
+
+uint32_t benchClockNow(void) {
+  auto elapsed = std::chrono::steady_clock::now() - origin;
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
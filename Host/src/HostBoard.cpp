@@ -0,0 +1,74 @@
+//*****************************************************************************************************
+//
+// File:      HostBoard.cpp
+// Author:    Aiko Pras
+// History:   2026/02/14 AP Version 1.0
+//            2026/02/18 AP Version 1.1: advance, setAnalog and shortcut
+//            2026/02/19 AP Version 1.2: idle
+//
+// Purpose:   Table with the entry points of this copy of the library, for multi-board programs
+//
+// See Host.h. The functions in the table are defined here, so that their addresses are those of
+// the copy of the library in which hostBoard() is called.
+//
+//*****************************************************************************************************
+#include <array>
+#include "Host.h"
+#include "Relays.h"
+
+
+static void boardSetup(void) {
+  hostSketch.setup();
+}
+
+
+static void boardLoop(void) {
+  hostSketch.loop();
+}
+
+
+static void boardPacket(uint64_t atCycles, const uint8_t *data, uint8_t length) {
+  std::array<uint8_t, HOST_DCC_MAX_BYTES> bytes = {};
+  memcpy(bytes.data(), data, (length < HOST_DCC_MAX_BYTES) ? length : HOST_DCC_MAX_BYTES);
+  hostIo.at(atCycles, [bytes, length]() {hostDcc.packet(bytes.data(), length);});
+}
+
+
+static uint16_t boardRelayPins(void) {
+  return hostSketch.relayPins();
+}
+
+
+static void boardAdvance(uint64_t numCycles) {
+  hostIo.advance(numCycles);
+}
+
+
+static void boardSetAnalog(uint8_t muxpos, uint16_t value) {
+  hostIo.setAnalog(muxpos, value);
+}
+
+
+static bool boardShortcut(uint8_t muxpos, uint8_t maxValue, uint16_t *result) {
+  relays.adc.maxValue = maxValue;
+  bool shortcut = relays.adc.shortcut(muxpos);
+  if (result) *result = ADC0.RES.value;
+  return shortcut;
+}
+
+
+static void boardIdle(uint64_t ms) {
+  hostSketch.idle(ms);
+}
+
+
+static const HostBoard board = {
+  &hostIo, &hostDcc, &hostSketch, EEPROM.data,
+  boardSetup, boardLoop, boardPacket, boardRelayPins,
+  boardAdvance, boardSetAnalog, boardShortcut, boardIdle
+};
+
+
+extern "C" const HostBoard *hostBoard(void) {
+  return &board;
+}
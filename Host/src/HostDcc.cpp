@@ -0,0 +1,397 @@
+//*****************************************************************************************************
+//
+// File:      HostDcc.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/12 AP Version 1.1: An empty poll takes time
+//            2026/02/13 AP Version 1.2: Packets and bit timings, as the ISR delivers them
+//            2026/02/16 AP Version 1.3: A returned command opens a hostAccess command window
+//            2026/02/20 AP Version 1.4: 0111xxxx packets are only service mode after a reset;
+//                                        passQueued
+//
+// Purpose:   Mock of AP_DCC_library: commands come from a queue filled by the host program
+//
+// Each call of dcc.input() takes at most one command from hostDcc.queue, and returns true if it
+// did. As in the real library, accessory commands for other decoders are returned as
+// AnyAccessoryCmd, and PoM commands for other decoders as AnyPomCmd. Loco function commands for
+// other locos are dropped (the real library returns IgnoreCmd, which the sources skip as well).
+// A call that finds no command costs HOST_POLL_CYCLES, so that loops in the sources that wait for
+// a command (address programming) let the clock, and scheduled host actions, proceed.
+// Packets (hostDcc.packet()) are decoded by input() as in the real library. Idle packets,
+// packets with a wrong error detection byte, loco speed commands and service mode packets outside
+// the service mode window are taken from the queue but not returned.
+//
+//*****************************************************************************************************
+#include "Host.h"
+
+Dcc dcc;
+Accessory accCmd;
+Loco locoCmd;
+CvAccess cvCmd;
+hostDcc_class hostDcc;
+
+
+//*****************************************************************************************************
+// Injection by the host program
+//*****************************************************************************************************
+void hostDcc_class::reset(void) {
+  queue.clear();
+  attached = false;
+  acks = 0;
+  inputs = 0;
+  packets = 0;
+  dropped = 0;
+  badChecksum = 0;
+  ignored = 0;
+  latencySum = 0;
+  latencyMax = 0;
+  passQueued = 0;
+  resetPacket = 0;
+}
+
+
+void hostDcc_class::push(HostDccCmd &cmd) {
+  cmd.queued = hostIo.cycles;
+  queue.push_back(cmd);
+}
+
+
+void hostDcc_class::accessory(uint16_t outputAddress, uint8_t position, uint8_t activate) {
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::ACC_BASIC;
+  cmd.address = outputAddress;
+  cmd.position = position;
+  cmd.activate = activate;
+  push(cmd);
+}
+
+
+void hostDcc_class::extended(uint16_t outputAddress, uint8_t aspect) {
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::ACC_EXTENDED;
+  cmd.address = outputAddress;
+  cmd.position = aspect;
+  push(cmd);
+}
+
+
+void hostDcc_class::functions(uint16_t locoAddress, uint8_t group, uint8_t bits) {
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::LOCO_FUNCTIONS;
+  cmd.address = locoAddress;
+  cmd.position = group;
+  cmd.activate = bits;
+  push(cmd);
+}
+
+
+void hostDcc_class::pom(uint16_t address, uint16_t cvNumber, uint8_t value,
+                        CvAccess::operation_t operation) {
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::POM;
+  cmd.address = address;
+  cmd.cvNumber = cvNumber;
+  cmd.cvValue = value;
+  cmd.operation = operation;
+  push(cmd);
+}
+
+
+void hostDcc_class::sm(uint16_t cvNumber, uint8_t value, CvAccess::operation_t operation) {
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::SM;
+  cmd.cvNumber = cvNumber;
+  cmd.cvValue = value;
+  cmd.operation = operation;
+  push(cmd);
+}
+
+
+bool hostDcc_class::packet(const uint8_t *data, uint8_t length) {
+  packets++;
+  uint8_t buffered = 0;
+  for (const HostDccCmd &cmd : queue) {
+    if (cmd.kind == HostDccCmd::PACKET) buffered++;
+  }
+  if ((buffered >= HOST_DCC_PACKETS) || (length > HOST_DCC_MAX_BYTES)) {
+    dropped++;
+    return false;
+  }
+  HostDccCmd cmd = {};
+  cmd.kind = HostDccCmd::PACKET;
+  cmd.length = length;
+  memcpy(cmd.data, data, length);
+  push(cmd);
+  return true;
+}
+
+
+//*****************************************************************************************************
+// Packet decoding
+//*****************************************************************************************************
+// PoM and service mode: 1110CCVV VVVVVVVV DDDDDDDD (PoM) or 0111CCVV ... (SM), CC: 01 = verify,
+// 11 = write, 10 = bit manipulation. The CV number is the 10-bit V + 1
+static bool decodeCv(const uint8_t *d) {
+  switch ((d[0] >> 2) & 0x03) {
+    case 1:  cvCmd.operation = CvAccess::verifyByte;      break;
+    case 3:  cvCmd.operation = CvAccess::writeByte;       break;
+    case 2:  cvCmd.operation = CvAccess::bitManipulation; break;
+    default: return false;
+  }
+  cvCmd.number = (((d[0] & 0x03) << 8) | d[1]) + 1;
+  cvCmd.value = d[2];
+  cvCmd.writecmd = (d[2] & 0x10);
+  cvCmd.bitvalue = (d[2] >> 3) & 0x01;
+  cvCmd.bitposition = d[2] & 0x07;
+  return true;
+}
+
+
+bool hostDcc_class::decode(const HostDccCmd &cmd) {
+  const uint8_t *d = cmd.data;
+  uint8_t n = cmd.length;
+  uint8_t check = 0;
+  for (uint8_t i = 0; i < n; i++) check ^= d[i];
+  if ((n < 3) || (check != 0)) {
+    badChecksum++;
+    return false;
+  }
+  n--;                                             // Without the error detection byte
+  if (d[0] == 0xFF) return false;                  // Idle packet
+  if ((d[0] == 0x00) && (d[1] == 0x00)) {          // Reset packet
+    resetPacket = hostIo.cycles;
+    dcc.cmdType = Dcc::ResetCmd;
+    return true;
+  }
+  // Service mode, direct mode: no address byte, 3 bytes. Only directly after a reset packet; other
+  // packets that start with 0111 are for short loco addresses 112..127 (such as F13..F28)
+  uint64_t window = (uint64_t)HOST_DCC_SM_MS * (F_CPU / 1000UL);
+  bool serviceMode = (resetPacket != 0) && (hostIo.cycles - resetPacket <= window);
+  if ((n == 3) && ((d[0] & 0xF0) == 0x70) && serviceMode) {
+    if (!decodeCv(d)) return false;
+    resetPacket = hostIo.cycles;
+    dcc.cmdType = Dcc::SmCmd;
+    return true;
+  }
+  // Accessory: 10AAAAAA 1AAACDDD (basic) or 10AAAAAA 0AAA0AA1 XXXXXXXX (extended).
+  // The three high address bits in the second byte are inverted
+  if ((d[0] & 0xC0) == 0x80) {
+    uint16_t address = (d[0] & 0x3F) | ((~d[1] & 0x70) << 2);
+    uint8_t port = (d[1] >> 1) & 0x03;
+    accCmd.decoderAddress = address;
+    accCmd.device = port + 1;
+    accCmd.outputAddress = (address << 2) + port + 1;
+    if ((n == 5) && (d[1] & 0x80) && ((d[2] & 0xF0) == 0xE0)) {  // Accessory PoM
+      if (!decodeCv(&d[2])) return false;
+      dcc.cmdType = (address == accCmd.myAddress) ? Dcc::MyPomCmd : Dcc::AnyPomCmd;
+      return true;
+    }
+    if ((n == 2) && (d[1] & 0x80)) {
+      accCmd.command = Accessory::basic;
+      accCmd.position = d[1] & 0x01;
+      accCmd.activate = (d[1] >> 3) & 0x01;
+    }
+    else if ((n == 3) && ((d[1] & 0x89) == 0x01)) {
+      accCmd.command = Accessory::extended;
+      accCmd.signalAspect = d[2];
+    }
+    else return false;
+    dcc.cmdType = (address == accCmd.myAddress) ? Dcc::MyAccessoryCmd : Dcc::AnyAccessoryCmd;
+    return true;
+  }
+  // Multi-function decoders: short (0AAAAAAA) or long (11AAAAAA AAAAAAAA) address
+  uint16_t address;
+  uint8_t i;
+  if ((d[0] >= 1) && (d[0] <= 127)) {address = d[0]; i = 1;}
+  else if ((d[0] & 0xC0) == 0xC0) {address = ((d[0] & 0x3F) << 8) | d[1]; i = 2;}
+  else return false;
+  if (i >= n) return false;
+  uint8_t instruction = d[i];
+  if ((instruction & 0xF0) == 0xE0) {              // PoM, long form
+    if ((i + 3 != n) || !decodeCv(&d[i])) return false;
+    dcc.cmdType = ((address == locoCmd.myAddress) || (address == accCmd.myAddress)) ? Dcc::MyPomCmd : Dcc::AnyPomCmd;
+    return true;
+  }
+  if (address != locoCmd.myAddress) return false;
+  if ((instruction & 0xE0) == 0x80)      {locoCmd.F0F4 = instruction & 0x1F; dcc.cmdType = Dcc::MyLocoF0F4Cmd;}
+  else if ((instruction & 0xF0) == 0xB0) {locoCmd.F5F8 = instruction & 0x0F; dcc.cmdType = Dcc::MyLocoF5F8Cmd;}
+  else if ((instruction & 0xF0) == 0xA0) {locoCmd.F9F12 = instruction & 0x0F; dcc.cmdType = Dcc::MyLocoF9F12Cmd;}
+  else if ((instruction == 0xDE) && (i + 2 == n)) {locoCmd.F13F20 = d[i + 1]; dcc.cmdType = Dcc::MyLocoF13F20Cmd;}
+  else if ((instruction == 0xDF) && (i + 2 == n)) {locoCmd.F21F28 = d[i + 1]; dcc.cmdType = Dcc::MyLocoF21F28Cmd;}
+  else return false;                               // Speed and other instructions are not used
+  return true;
+}
+
+
+//*****************************************************************************************************
+// Bit timings
+//*****************************************************************************************************
+void HostDccBits::reset(void) {
+  length = 0;
+  errors = 0;
+  lastHalf = -1;
+  inPacket = false;
+  ones = 0;
+}
+
+
+bool HostDccBits::addBit(uint8_t b) {
+  if (!inPacket) {
+    if (b) {
+      if (ones < 255) ones++;
+    }
+    else {
+      inPacket = (ones >= HOST_DCC_PREAMBLE);      // The packet start bit
+      ones = 0;
+      length = 0;
+      numBits = 0;
+      value = 0;
+    }
+    return false;
+  }
+  if (numBits < 8) {
+    value = (value << 1) | b;
+    if (++numBits < 8) return false;
+    if (length >= HOST_DCC_MAX_BYTES) {
+      errors++;
+      inPacket = false;
+      return false;
+    }
+    data[length++] = value;
+    return false;
+  }
+  numBits = 0;                                     // A data byte start bit or the packet end bit
+  value = 0;
+  if (b == 0) return false;
+  inPacket = false;
+  ones = 1;                                        // The end bit may be part of the next preamble
+  return true;
+}
+
+
+bool HostDccBits::halfBit(uint32_t us) {
+  int8_t half;
+  if ((us >= 52) && (us <= 64)) half = 1;
+  else if ((us >= 90) && (us <= 10000)) half = 0;
+  else {
+    errors++;
+    lastHalf = -1;
+    inPacket = false;
+    ones = 0;
+    return false;
+  }
+  if (lastHalf != half) {
+    lastHalf = half;
+    return false;
+  }
+  lastHalf = -1;
+  return addBit(half);
+}
+
+
+//*****************************************************************************************************
+// Library API, as used by the decoder sources
+//*****************************************************************************************************
+void Dcc::attach(uint8_t dccInputPin, uint8_t ackOutputPin) {
+  (void)dccInputPin;
+  (void)ackOutputPin;
+  hostDcc.attached = true;
+}
+
+
+void Dcc::detach(void) {
+  hostDcc.attached = false;
+  throw HostReboot();
+}
+
+
+void Dcc::sendAck(void) {
+  hostDcc.acks++;
+}
+
+
+static void setCv(const HostDccCmd &cmd) {
+  cvCmd.number = cmd.cvNumber;
+  cvCmd.operation = cmd.operation;
+  cvCmd.value = cmd.cvValue;
+  // Bit manipulation: the value byte is 111KDBBB (K: write, D: bit value, BBB: bit position)
+  cvCmd.writecmd = (cmd.cvValue & 0x10);
+  cvCmd.bitvalue = (cmd.cvValue >> 3) & 0x01;
+  cvCmd.bitposition = cmd.cvValue & 0x07;
+}
+
+
+bool Dcc::input(void) {
+  while (hostDcc.attached && !hostDcc.queue.empty()) {
+    HostDccCmd cmd = hostDcc.queue.front();
+    hostDcc.queue.pop_front();
+    switch (cmd.kind) {
+      case HostDccCmd::ACC_BASIC:
+      case HostDccCmd::ACC_EXTENDED:
+        accCmd.command = (cmd.kind == HostDccCmd::ACC_BASIC) ? Accessory::basic : Accessory::extended;
+        accCmd.outputAddress = cmd.address;
+        accCmd.decoderAddress = (cmd.address - 1) >> 2;
+        accCmd.device = ((cmd.address - 1) & 0x03) + 1;
+        accCmd.position = cmd.position;
+        accCmd.activate = cmd.activate;
+        accCmd.signalAspect = cmd.position;
+        cmdType = (accCmd.decoderAddress == accCmd.myAddress) ? MyAccessoryCmd : AnyAccessoryCmd;
+      break;
+      case HostDccCmd::LOCO_FUNCTIONS:
+        if (cmd.address != locoCmd.myAddress) continue;
+        switch (cmd.position) {
+          case 0: locoCmd.F0F4 = cmd.activate;   cmdType = MyLocoF0F4Cmd;   break;
+          case 1: locoCmd.F5F8 = cmd.activate;   cmdType = MyLocoF5F8Cmd;   break;
+          case 2: locoCmd.F9F12 = cmd.activate;  cmdType = MyLocoF9F12Cmd;  break;
+          case 3: locoCmd.F13F20 = cmd.activate; cmdType = MyLocoF13F20Cmd; break;
+          default: locoCmd.F21F28 = cmd.activate; cmdType = MyLocoF21F28Cmd; break;
+        }
+      break;
+      case HostDccCmd::POM:
+        setCv(cmd);
+        if ((cmd.address == locoCmd.myAddress) || (cmd.address == accCmd.myAddress)) cmdType = MyPomCmd;
+        else cmdType = AnyPomCmd;
+      break;
+      case HostDccCmd::SM:
+        setCv(cmd);
+        cmdType = SmCmd;
+      break;
+      case HostDccCmd::PACKET:
+        if (!hostDcc.decode(cmd)) {
+          hostDcc.ignored++;
+          continue;
+        }
+      break;
+    }
+    uint64_t latency = hostIo.cycles - cmd.queued;
+    hostDcc.latencySum += latency;
+    if (latency > hostDcc.latencyMax) hostDcc.latencyMax = latency;
+    hostDcc.inputs++;
+    hostDcc.passQueued = cmd.queued;
+    hostAccess.beginCommand(cmdType);
+    return true;
+  }
+  hostIo.advance(HOST_POLL_CYCLES);
+  return false;
+}
+
+
+void Accessory::setMyAddress(uint16_t address) {
+  myAddress = address;
+}
+
+
+void Loco::setMyAddress(uint16_t address) {
+  myAddress = address;
+}
+
+
+uint8_t CvAccess::writeBit(uint8_t currentValue) {
+  if (bitvalue) return currentValue | (1 << bitposition);
+  return currentValue & ~(1 << bitposition);
+}
+
+
+bool CvAccess::verifyBit(uint8_t currentValue) {
+  return ((currentValue >> bitposition) & 0x01) == bitvalue;
+}
@@ -0,0 +1,450 @@
+//*****************************************************************************************************
+//
+// File:      HostIo.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: ADC and EEPROM timing, pin edge times
+//            2026/02/12 AP Version 1.2: Scheduled actions, skip()
+//            2026/02/13 AP Version 1.3: nextAction()
+//            2026/02/16 AP Version 1.4: ADC conversions are counted by hostAccess
+//            2026/02/17 AP Version 1.5: Pin, TCA0 and analog input changes go to hostTrace
+//            2026/02/19 AP Version 1.6: pinWatch
+//
+// Purpose:   Models of the AVR DA peripherals used by the decoder sources, and the virtual clock
+//
+// The models are functional, and charge the virtual clock for the time the sources have to wait:
+// - PORT / VPORT: OUT, DIR and IN are kept consistent, whether they are written via the PORT
+//   registers (OUTSET, DIRCLR, PINCTRLUPD, ...) or via the VPORT registers. IN reflects OUT for
+//   output pins, and the external level (setPin()) for input pins. Edges on input pins set
+//   INTFLAGS and raise the port interrupt, according to the ISC bits in PINnCTRL. The time of
+//   the last edge of each pin is kept in risen[] / fallen[].
+// - ADC0: a conversion takes adcCycles(): 2 + SAMPLEN ADC clocks to sample, plus one per result
+//   bit and one to store RES, times the number of accumulated samples. The ADC clock follows from
+//   the prescaler in CTRLC: with DIV12 a 10-bit conversion takes 13 * 12 = 156 CPU cycles (6,5 us).
+//   RES then holds the value given by setAnalog() for MUXPOS. Each read of INTFLAGS costs one
+//   pass of a polling loop (HOST_POLL_CYCLES), so the busy-wait in adc_class::shortcut() runs
+//   until the conversion is done.
+// - NVMCTRL: STATUS.EEBUSY is set for HOST_EEPROM_WRITE_US after each EEPROM byte write (via the
+//   EEPROM mock); reads of STATUS are charged like those of ADC0.INTFLAGS.
+// - TCB0..3: periodic interrupt mode only. advance() runs the clock up to the next event (an
+//   action scheduled by the host program, a TCB period that ends, or a conversion that
+//   completes), handles it, and repeats; ISRs of several timers thus run in the right order.
+// - TCA0, VREF, PORTMUX: registers only.
+// Interrupts are delivered if the I flag in SREG is set, at the moment the host program calls
+// advance() or setPin(). During an ISR the I flag is cleared, as on the AVR.
+//
+//*****************************************************************************************************
+#include "Host.h"
+
+HostIoSpace hostIoSpace;
+uint8_t SREG = SREG_I;                  // The Arduino core enables interrupts before setup()
+hostIo_class hostIo;
+
+// Vectors that the sources do not define
+extern "C" {
+  __attribute__((weak)) void PORTA_PORT_vect(void) {}
+  __attribute__((weak)) void PORTB_PORT_vect(void) {}
+  __attribute__((weak)) void PORTC_PORT_vect(void) {}
+  __attribute__((weak)) void PORTD_PORT_vect(void) {}
+  __attribute__((weak)) void PORTE_PORT_vect(void) {}
+  __attribute__((weak)) void PORTF_PORT_vect(void) {}
+  __attribute__((weak)) void TCB0_INT_vect(void) {}
+  __attribute__((weak)) void TCB1_INT_vect(void) {}
+  __attribute__((weak)) void TCB2_INT_vect(void) {}
+  __attribute__((weak)) void TCB3_INT_vect(void) {}
+}
+
+typedef void (*Vector)(void);
+static const Vector portVector[HOST_PORTS] = {
+  PORTA_PORT_vect, PORTB_PORT_vect, PORTC_PORT_vect, PORTD_PORT_vect, PORTE_PORT_vect, PORTF_PORT_vect
+};
+static const Vector tcbVector[HOST_TCBS] = {TCB0_INT_vect, TCB1_INT_vect, TCB2_INT_vect, TCB3_INT_vect};
+
+
+// Returns the offset of reg within peripheral, or -1 if it is not part of it
+template <typename T> static int offsetIn(const void *reg, const T &peripheral) {
+  const uint8_t *p = (const uint8_t *)reg;
+  const uint8_t *base = (const uint8_t *)&peripheral;
+  if ((p < base) || (p >= base + sizeof(T))) return -1;
+  return (int)(p - base);
+}
+
+
+// Returns which of the peripherals in array holds reg (and its offset therein), or -1
+template <typename T, size_t N> static int indexIn(const void *reg, const T (&array)[N], int &offset) {
+  offset = offsetIn(reg, array);
+  if (offset < 0) return -1;
+  int n = offset / sizeof(T);
+  offset -= n * sizeof(T);
+  return n;
+}
+
+
+//*****************************************************************************************************
+// Register access
+//*****************************************************************************************************
+void hostIoWrite(Reg8 *reg, uint8_t value) {
+  HostIoSpace &io = hostIoSpace;
+  int offset;
+  int n = indexIn(reg, io.vport, offset);
+  if (n >= 0) {
+    PORT_t &port = io.port[n];
+    switch (offset) {
+      case 0: port.DIR.value = value; break;
+      case 1: port.OUT.value = value; break;
+      case 2: port.OUT.value ^= value; break;                // Writing IN toggles OUT
+      case 3: port.INTFLAGS.value &= ~value; break;          // Write 1 to clear
+    }
+    hostIo.portWritten(n);
+    return;
+  }
+  n = indexIn(reg, io.port, offset);
+  if (n >= 0) {
+    PORT_t &port = io.port[n];
+    volatile uint8_t *pinCtrl = &port.PIN0CTRL;
+    switch (offset) {
+      case 0x00: port.DIR.value = value; break;
+      case 0x01: port.DIR.value |= value; break;
+      case 0x02: port.DIR.value &= ~value; break;
+      case 0x03: port.DIR.value ^= value; break;
+      case 0x04: port.OUT.value = value; break;
+      case 0x05: port.OUT.value |= value; break;
+      case 0x06: port.OUT.value &= ~value; break;
+      case 0x07: port.OUT.value ^= value; break;
+      case 0x08: port.OUT.value ^= value; break;
+      case 0x09: port.INTFLAGS.value &= ~value; break;
+      case 0x0B: port.PINCONFIG.value = value; break;
+      case 0x0C:
+      case 0x0D:
+      case 0x0E:
+        for (uint8_t bit = 0; bit < 8; bit++) {
+          if (!(value & (1 << bit))) continue;
+          if (offset == 0x0C) pinCtrl[bit] = port.PINCONFIG.value;
+          else if (offset == 0x0D) pinCtrl[bit] |= port.PINCONFIG.value;
+          else pinCtrl[bit] &= ~port.PINCONFIG.value;
+        }
+      break;
+      default: reg->value = value; break;
+    }
+    hostIo.portWritten(n);
+    return;
+  }
+  if (offsetIn(reg, io.adc0) >= 0) {
+    if (reg == &io.adc0.INTFLAGS) io.adc0.INTFLAGS.value &= ~value;
+    else if (reg == &io.adc0.COMMAND) {
+      reg->value = value;
+      if ((value & ADC_STCONV_bm) && (io.adc0.CTRLA.value & ADC_ENABLE_bm)) {
+        hostAccess.record(ACCESS_ADC_CONVERSION, HOST_ACCESS_SITE);
+        hostIo.adcStart();
+      }
+    }
+    else reg->value = value;
+    return;
+  }
+  if (offsetIn(reg, io.tca0) >= 0) {
+    reg->value = value;
+    hostTrace.pinsChanged();                                // PWM of LED_DCC and LED_ACC
+    return;
+  }
+  n = indexIn(reg, io.tcb, offset);
+  if ((n >= 0) && (reg == &io.tcb[n].INTFLAGS)) {
+    reg->value &= ~value;
+    return;
+  }
+  reg->value = value;
+}
+
+
+void hostIoWrite(Reg16 *reg, uint16_t value) {
+  reg->value = value;
+}
+
+
+uint8_t hostIoRead(Reg8 *reg) {
+  // Status flags are read in polling loops, which take time
+  if (reg == &hostIoSpace.adc0.INTFLAGS) hostIo.advance(HOST_POLL_CYCLES);
+  if (reg == &hostIoSpace.nvmctrl.STATUS) {
+    hostIo.advance(HOST_POLL_CYCLES);
+    return hostIo.eepromBusy() ? NVMCTRL_EEBUSY_bm : 0;
+  }
+  // The strobe registers (DIRSET .. OUTTGL) read as DIR or OUT
+  int offset;
+  int n = indexIn(reg, hostIoSpace.port, offset);
+  if ((offset >= 0x01) && (offset <= 0x03)) return hostIoSpace.port[n].DIR.value;
+  if ((offset >= 0x05) && (offset <= 0x07)) return hostIoSpace.port[n].OUT.value;
+  return reg->value;
+}
+
+
+uint16_t hostIoRead(Reg16 *reg) {
+  for (uint8_t n = 0; n < HOST_TCBS; n++) {
+    TCB_t &tcb = hostIoSpace.tcb[n];
+    if (reg == &tcb.CNT) {
+      uint8_t prescaler = ((tcb.CTRLA.value & TCB_CLKSEL_gm) == TCB_CLKSEL_DIV2_gc) ? 2 : 1;
+      return (uint16_t)(hostIo.tcbCycles(n) / prescaler);
+    }
+  }
+  return reg->value;
+}
+
+
+//*****************************************************************************************************
+// Ports
+//*****************************************************************************************************
+void hostIo_class::reset(void) {
+  cycles = 0;
+  actions.clear();
+  conversions = 0;
+  eepromReady = 0;
+  memset(risen, 0, sizeof(risen));
+  memset(fallen, 0, sizeof(fallen));
+  for (uint8_t n = 0; n < HOST_PORTS; n++) extIn[n] = 0xFF;
+  for (uint8_t n = 0; n < 64; n++) setAnalog(n, 0);
+  reboot();
+}
+
+
+void hostIo_class::reboot(void) {
+  memset((void *)&hostIoSpace, 0, sizeof(hostIoSpace));
+  SREG = SREG_I;
+  bootCycles = cycles;
+  adcBusy = false;
+  portPending = 0;
+  tcbPending = 0;
+  for (uint8_t n = 0; n < HOST_PORTS; n++) {
+    portWritten(n);
+    lastIn[n] = hostIoSpace.port[n].IN.value;
+  }
+  for (uint8_t n = 0; n < HOST_TCBS; n++) tcbCount[n] = 0;
+}
+
+
+void hostIo_class::portWritten(uint8_t n) {
+  PORT_t &port = hostIoSpace.port[n];
+  VPORT_t &vport = hostIoSpace.vport[n];
+  uint8_t oldIn = port.IN.value;
+  port.IN.value = (port.OUT.value & port.DIR.value) | (extIn[n] & ~port.DIR.value);
+  uint8_t changed = oldIn ^ port.IN.value;
+  for (uint8_t bit = 0; changed; bit++, changed >>= 1) {
+    if (!(changed & 1)) continue;
+    if (port.IN.value & (1 << bit)) risen[n * 8 + bit] = cycles;
+    else fallen[n * 8 + bit] = cycles;
+  }
+  vport.DIR.value = port.DIR.value;
+  vport.OUT.value = port.OUT.value;
+  vport.IN.value = port.IN.value;
+  vport.INTFLAGS.value = port.INTFLAGS.value;
+  senseEdges(n);
+  hostTrace.pinsChanged();
+  if (pinWatch) pinWatch(pinWatchContext, n);
+}
+
+
+void hostIo_class::senseEdges(uint8_t n) {
+  PORT_t &port = hostIoSpace.port[n];
+  uint8_t in = port.IN.value;
+  uint8_t changed = in ^ lastIn[n];
+  lastIn[n] = in;
+  volatile uint8_t *pinCtrl = &port.PIN0CTRL;
+  uint8_t flags = 0;
+  for (uint8_t bit = 0; bit < 8; bit++) {
+    uint8_t mask = 1 << bit;
+    bool level = in & mask;
+    switch (pinCtrl[bit] & PORT_ISC_gm) {
+      case PORT_ISC_BOTHEDGES_gc: if (changed & mask) flags |= mask; break;
+      case PORT_ISC_RISING_gc:    if ((changed & mask) && level) flags |= mask; break;
+      case PORT_ISC_FALLING_gc:   if ((changed & mask) && !level) flags |= mask; break;
+      case PORT_ISC_LEVEL_gc:     if (!level) flags |= mask; break;
+    }
+  }
+  if (!flags) return;
+  port.INTFLAGS.value |= flags;
+  hostIoSpace.vport[n].INTFLAGS.value = port.INTFLAGS.value;
+  portPending |= (1 << n);
+}
+
+
+void hostIo_class::setPin(uint8_t pin, bool level) {
+  uint8_t n = digitalPinToPort(pin);
+  if (level) extIn[n] |= digitalPinToBitMask(pin);
+  else extIn[n] &= ~digitalPinToBitMask(pin);
+  portWritten(n);
+  deliverInterrupts();
+}
+
+
+bool hostIo_class::pin(uint8_t pin) {
+  return hostIoSpace.port[digitalPinToPort(pin)].IN.value & digitalPinToBitMask(pin);
+}
+
+
+//*****************************************************************************************************
+// ADC
+//*****************************************************************************************************
+void hostIo_class::setAnalog(uint8_t muxpos, uint16_t value) {
+  ain[muxpos & 0x3F] = value;
+  hostTrace.analogChanged(muxpos, value);
+}
+
+
+static const uint8_t adcPrescaler[16] = {2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64};
+
+
+uint64_t hostIo_class::adcCycles(void) {
+  ADC_t &adc = hostIoSpace.adc0;
+  uint8_t bits = ((adc.CTRLA.value & ADC_RESSEL_gm) == ADC_RESSEL_10BIT_gc) ? 10 : 12;
+  uint8_t samples = 1 << (adc.CTRLB.value & ADC_SAMPNUM_gm);
+  uint64_t adcClocks = (uint64_t)samples * (2 + adc.SAMPCTRL.value + bits + 1);
+  return adcClocks * adcPrescaler[adc.CTRLC.value & ADC_PRESC_gm];
+}
+
+
+void hostIo_class::adcStart(void) {
+  adcBusy = true;
+  adcReady = cycles + adcCycles();
+}
+
+
+void hostIo_class::adcComplete(void) {
+  ADC_t &adc = hostIoSpace.adc0;
+  uint16_t max = ((adc.CTRLA.value & ADC_RESSEL_gm) == ADC_RESSEL_10BIT_gc) ? 0x3FF : 0xFFF;
+  uint16_t value = ain[adc.MUXPOS.value & 0x3F];
+  // Accumulated samples are added up in RES
+  uint8_t samples = 1 << (adc.CTRLB.value & ADC_SAMPNUM_gm);
+  adc.RES.value = ((value > max) ? max : value) * samples;
+  adc.INTFLAGS.value |= ADC_RESRDY_bm;
+  adc.COMMAND.value &= ~ADC_STCONV_bm;
+  adcBusy = false;
+  conversions++;
+}
+
+
+//*****************************************************************************************************
+// EEPROM
+//*****************************************************************************************************
+void hostIo_class::eepromWait(void) {
+  // Equal to polling STATUS, rounded up to whole polling loop passes, but in one step
+  if (!eepromBusy()) return;
+  uint64_t wait = eepromReady - cycles;
+  advance(((wait + HOST_POLL_CYCLES - 1) / HOST_POLL_CYCLES) * HOST_POLL_CYCLES);
+}
+
+
+void hostIo_class::eepromWrite(void) {
+  eepromReady = cycles + (uint64_t)HOST_EEPROM_WRITE_US * (F_CPU / 1000000UL);
+}
+
+
+//*****************************************************************************************************
+// Timers and interrupts
+//*****************************************************************************************************
+uint64_t hostIo_class::tcbPeriod(uint8_t n) {
+  TCB_t &tcb = hostIoSpace.tcb[n];
+  if (!(tcb.CTRLA.value & TCB_ENABLE_bm)) return 0;
+  if ((tcb.CTRLB.value & TCB_CNTMODE_gm) != TCB_CNTMODE_INT_gc) return 0;
+  uint8_t prescaler = ((tcb.CTRLA.value & TCB_CLKSEL_gm) == TCB_CLKSEL_DIV2_gc) ? 2 : 1;
+  return ((uint64_t)tcb.CCMP.value + 1) * prescaler;
+}
+
+
+#define EVENT_NONE   -1
+#define EVENT_ADC    HOST_TCBS                             // 0 .. HOST_TCBS - 1: TCBn period
+#define EVENT_ACTION (HOST_TCBS + 1)
+
+
+void hostIo_class::at(uint64_t atCycles, HostAction action) {
+  actions.emplace(atCycles, action);
+}
+
+
+uint64_t hostIo_class::nextAction(void) {
+  return actions.empty() ? UINT64_MAX : actions.begin()->first;
+}
+
+
+void hostIo_class::skip(uint64_t ms) {
+  cycles += ms * (F_CPU / 1000UL);
+  // Actions that were due in between run now, at the end of the skip
+  advance(0);
+}
+
+
+void hostIo_class::skipToMillis(uint32_t ms) {
+  uint32_t now = millis();
+  skip((uint32_t)(ms - now));
+}
+
+
+void hostIo_class::advance(uint64_t numCycles) {
+  uint64_t end = cycles + numCycles;
+  // Events at `end` itself are handled as well. An ISR or action may itself advance the clock (by
+  // polling a flag); if that passes `end`, the loop ends at once
+  while (cycles <= end) {
+    // Find the first event
+    uint64_t step = end - cycles;
+    int8_t first = EVENT_NONE;
+    for (uint8_t n = 0; n < HOST_TCBS; n++) {
+      uint64_t period = tcbPeriod(n);
+      if (!period) continue;
+      if (tcbCount[n] >= period) tcbCount[n] = 0;           // CCMP was lowered
+      uint64_t left = period - tcbCount[n];
+      if (left <= step) {
+        step = left;
+        first = n;
+      }
+    }
+    if (adcBusy) {
+      uint64_t left = (adcReady > cycles) ? adcReady - cycles : 0;  // May have passed by skip()
+      if (left <= step) {
+        step = left;
+        first = EVENT_ADC;
+      }
+    }
+    if (!actions.empty()) {
+      uint64_t when = actions.begin()->first;
+      uint64_t left = (when > cycles) ? when - cycles : 0;
+      if (left <= step) {
+        step = left;
+        first = EVENT_ACTION;
+      }
+    }
+    for (uint8_t n = 0; n < HOST_TCBS; n++) if (tcbPeriod(n)) tcbCount[n] += step;
+    cycles += step;
+    if (first == EVENT_NONE) break;
+    if (first == EVENT_ADC) {
+      adcComplete();
+      continue;
+    }
+    if (first == EVENT_ACTION) {
+      HostAction action = actions.begin()->second;
+      actions.erase(actions.begin());
+      action();
+      deliverInterrupts();
+      continue;
+    }
+    tcbCount[first] = 0;
+    hostIoSpace.tcb[first].INTFLAGS.value |= TCB_CAPT_bm;
+    if (hostIoSpace.tcb[first].INTCTRL.value & TCB_CAPT_bm) tcbPending |= (1 << first);
+    deliverInterrupts();
+  }
+  deliverInterrupts();
+}
+
+
+void hostIo_class::deliverInterrupts(void) {
+  while ((SREG & SREG_I) && (portPending || tcbPending)) {
+    SREG &= ~SREG_I;
+    for (uint8_t n = 0; n < HOST_TCBS; n++) {
+      if (!(tcbPending & (1 << n))) continue;
+      tcbPending &= ~(1 << n);
+      tcbVector[n]();
+    }
+    for (uint8_t n = 0; n < HOST_PORTS; n++) {
+      if (!(portPending & (1 << n))) continue;
+      portPending &= ~(1 << n);
+      portVector[n]();
+      portWritten(n);                                       // The ISR may have cleared INTFLAGS
+    }
+    SREG |= SREG_I;                                         // RETI
+  }
+}
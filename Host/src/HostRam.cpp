@@ -0,0 +1,110 @@
+//*****************************************************************************************************
+//
+// File:      HostRam.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/16 AP Version 1.1: hostAccess is kept
+//            2026/02/17 AP Version 1.2: hostTrace is kept
+//
+// Purpose:   Snapshot and restore of the RAM of the decoder sources, to model a reboot
+//
+// The decoder sources and the mocks are linked into one shared library. Its writable PT_LOAD
+// segment holds .data and .bss, and thus all global and static variables of the sources. The
+// part of that segment that becomes read-only after relocation (PT_GNU_RELRO) is skipped.
+// The snapshot is taken once, before the first setup(); since the sources do not allocate heap
+// memory, copying the segment back returns them to the state in which the C startup code and
+// the constructors left them.
+//
+//*****************************************************************************************************
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <link.h>
+#include <stdlib.h>
+#include "Host.h"
+
+hostRam_class hostRam;
+
+
+struct Segment {
+  uintptr_t self;                                  // An address inside this library
+  uintptr_t start;
+  uintptr_t end;
+};
+
+
+static int findSegment(struct dl_phdr_info *info, size_t size, void *data) {
+  (void)size;
+  Segment *segment = (Segment *)data;
+  uintptr_t dataStart = 0;
+  uintptr_t dataEnd = 0;
+  uintptr_t relroEnd = 0;
+  bool ours = false;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+    uintptr_t end = start + phdr.p_memsz;
+    if (phdr.p_type == PT_LOAD) {
+      if ((segment->self >= start) && (segment->self < end)) ours = true;
+      if (phdr.p_flags & PF_W) {
+        dataStart = start;
+        dataEnd = end;
+      }
+    }
+    if (phdr.p_type == PT_GNU_RELRO) relroEnd = end;
+  }
+  if (!ours || (dataStart == 0)) return 0;
+  if (relroEnd > dataStart) dataStart = relroEnd;
+  segment->start = dataStart;
+  segment->end = dataEnd;
+  return 1;
+}
+
+
+void hostRam_class::snapshot(void) {
+  Segment segment = {(uintptr_t)&hostRam, 0, 0};
+  if (!dl_iterate_phdr(findSegment, &segment)) return;
+  keep(&hostRam, sizeof(hostRam));
+  keep(&hostIoSpace, sizeof(hostIoSpace));
+  keep(&SREG, sizeof(SREG));
+  keep(&hostIo, sizeof(hostIo));
+  keep(&EEPROM, sizeof(EEPROM));
+  keep(&hostDcc, sizeof(hostDcc));
+  keep(&hostSerial, sizeof(hostSerial));
+  keep(&hostSketch, sizeof(hostSketch));
+  keep(&hostAccess, sizeof(hostAccess));
+  keep(&hostTrace, sizeof(hostTrace));
+  start = (uint8_t *)segment.start;
+  size = segment.end - segment.start;
+  copy = (uint8_t *)malloc(size);
+  memcpy(copy, start, size);
+}
+
+
+void hostRam_class::restore(void) {
+  if (size == 0) return;
+  // Copy everything back, except the objects that are kept: these are copied in between
+  uint8_t *from = start;
+  uint8_t *to = start + size;
+  while (from < to) {
+    uint8_t *next = to;
+    uint8_t *skipTo = to;
+    for (uint8_t i = 0; i < numKeep; i++) {
+      if ((keepObject[i] >= from) && (keepObject[i] < next)) {
+        next = keepObject[i];
+        skipTo = keepObject[i] + keepSize[i];
+      }
+    }
+    memcpy(from, copy + (from - start), next - from);
+    from = skipTo;
+  }
+}
+
+
+void hostRam_class::keep(void *object, size_t objectSize) {
+  if (numKeep < HOST_RAM_KEEP) {
+    keepObject[numKeep] = (uint8_t *)object;
+    keepSize[numKeep] = objectSize;
+    numKeep++;
+  }
+}
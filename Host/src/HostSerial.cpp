@@ -0,0 +1,150 @@
+//*****************************************************************************************************
+//
+// File:      HostSerial.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: USART byte time
+//            2026/02/16 AP Version 1.2: Bytes are counted by hostAccess, at the call from the sources
+//
+// Purpose:   Mock of the Serial object; the output is collected by hostSerial
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include "Host.h"
+
+HardwareSerial Serial;
+hostSerial_class hostSerial;
+
+
+//*****************************************************************************************************
+// USART timing
+//*****************************************************************************************************
+void hostSerial_class::transmit(void) {
+  if (baud == 0) return;
+  uint64_t perByte = byteCycles();
+  // The buffer is full if the last byte leaves more than HOST_SERIAL_BUFFER byte times from now
+  uint64_t room = txReady - (HOST_SERIAL_BUFFER - 1) * perByte;
+  if ((txReady > (HOST_SERIAL_BUFFER - 1) * perByte) && (room > hostIo.cycles)) {
+    waitCycles += room - hostIo.cycles;
+    hostIo.advance(room - hostIo.cycles);
+  }
+  if (txReady < hostIo.cycles) txReady = hostIo.cycles;
+  txReady += perByte;
+}
+
+
+void hostSerial_class::flush(void) {
+  if (txReady > hostIo.cycles) hostIo.advance(txReady - hostIo.cycles);
+}
+
+
+//*****************************************************************************************************
+// Serial
+//*****************************************************************************************************
+// print() calls write() for each byte, and the print() variants call each other. The site that
+// hostAccess records for a byte is therefore the call from the sources into the outermost one.
+static const void *serialSite;
+
+class SerialSite {
+  public:
+    SerialSite(const void *caller) : outer(serialSite == NULL) {if (outer) serialSite = caller;}
+    ~SerialSite() {if (outer) serialSite = NULL;}
+  private:
+    bool outer;
+};
+
+#define SERIAL_SITE   SerialSite site(HOST_ACCESS_SITE)
+
+
+void HardwareSerial::begin(unsigned long baud) {
+  hostSerial.baud = baud;
+}
+
+
+void HardwareSerial::flush(void) {
+  hostSerial.flush();
+}
+
+
+size_t HardwareSerial::write(uint8_t c) {
+  SERIAL_SITE;
+  hostAccess.record(ACCESS_SERIAL_BYTE, serialSite);
+  hostSerial.transmit();
+  hostSerial.output += (char)c;
+  if (hostSerial.echo) putchar(c);
+  return 1;
+}
+
+
+size_t HardwareSerial::print(const char *s) {
+  SERIAL_SITE;
+  size_t n = 0;
+  while (*s) n += write(*s++);
+  return n;
+}
+
+
+size_t HardwareSerial::print(char c) {
+  SERIAL_SITE;
+  return write(c);
+}
+
+
+size_t HardwareSerial::print(unsigned char n, int base) {
+  SERIAL_SITE;
+  return printNumber(n, base);
+}
+
+
+size_t HardwareSerial::print(int n, int base) {
+  SERIAL_SITE;
+  return print((long)n, base);
+}
+
+
+size_t HardwareSerial::print(unsigned int n, int base) {
+  SERIAL_SITE;
+  return printNumber(n, base);
+}
+
+
+size_t HardwareSerial::print(long n, int base) {
+  SERIAL_SITE;
+  // As in the Arduino core, only decimal numbers get a sign
+  if ((base == DEC) && (n < 0)) return write('-') + printNumber(-(unsigned long)n, DEC);
+  return printNumber((unsigned long)n, base);
+}
+
+
+size_t HardwareSerial::print(unsigned long n, int base) {
+  SERIAL_SITE;
+  return printNumber(n, base);
+}
+
+
+size_t HardwareSerial::print(double n, int digits) {
+  SERIAL_SITE;
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+  return print(buffer);
+}
+
+
+size_t HardwareSerial::println(void) {
+  SERIAL_SITE;
+  return write('\r') + write('\n');
+}
+
+
+size_t HardwareSerial::printNumber(unsigned long n, uint8_t base) {
+  char buffer[8 * sizeof(long) + 1];
+  char *s = &buffer[sizeof(buffer) - 1];
+  *s = 0;
+  if (base < 2) base = 10;
+  do {
+    uint8_t digit = n % base;
+    n /= base;
+    *--s = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+  } while (n);
+  return print(s);
+}
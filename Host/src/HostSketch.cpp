@@ -0,0 +1,128 @@
+//*****************************************************************************************************
+//
+// File:      HostSketch.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//            2026/02/11 AP Version 1.1: Loop latency
+//            2026/02/12 AP Version 1.2: idle()
+//            2026/02/13 AP Version 1.3: idle() wakes up for scheduled actions
+//            2026/02/16 AP Version 1.4: loop() ends the command window of hostAccess
+//            2026/02/20 AP Version 1.5: loop() clears hostDcc.passQueued
+//
+// Purpose:   setup() and loop() of the TMC 16-channel switch decoder sketch, for host programs
+//
+// setup() models power up: the RAM of the sources is reset (hostRam), as are the registers, the
+// virtual clock and the DCC queue. The EEPROM keeps its contents. loop() models one pass of the
+// sketch's loop(). If the sources reboot the decoder (Processor::reboot(), after a decoder reset
+// via CV8), dcc.detach() throws HostReboot; loop() catches it and runs setup() again, as the AVR
+// would after its jump to address 0. The DCC queue is kept in that case, since the command
+// station does not stop sending.
+// loop() also measures its own duration: the fixed HOST_LOOP_CYCLES, plus the time spent waiting
+// for peripherals (ADC, EEPROM, USART). maxLoopCycles thus estimates the worst-case latency with
+// which the decoder reacts to a new DCC command.
+//
+//*****************************************************************************************************
+#include "Host.h"
+#include "core_Functions.h"
+#include "Hardware.h"
+#include "MyDefaults.h"
+#include "Commands.h"
+
+hostSketch_class hostSketch;
+
+static const uint8_t relayPin[16] = {
+  RELAY1, RELAY2, RELAY3, RELAY4, RELAY5, RELAY6, RELAY7, RELAY8,
+  RELAY9, RELAY10, RELAY11, RELAY12, RELAY13, RELAY14, RELAY15, RELAY16
+};
+
+
+// The sketch itself
+static void sketchSetup(void) {
+  myDefaults_class myDefaults;
+  IO_Pin_class ioPins;
+  cvValues.init(TMC16ChannelSwitchDecoder, 10);
+  myDefaults.init();
+  ioPins.init();
+  decoderHardware.init();
+  commands.init();
+}
+
+
+static void sketchLoop(void) {
+  decoderHardware.update();
+  commands.update();
+}
+
+
+// Starts the sketch as after a reset. Returns after setup() completed without a reboot
+static void start(void) {
+  for (;;) {
+    if (hostRam.size == 0) hostRam.snapshot();
+    else hostRam.restore();
+    hostIo.reboot();
+    try {
+      sketchSetup();
+      return;
+    }
+    catch (HostReboot &) {
+      hostSketch.reboots++;
+    }
+  }
+}
+
+
+void hostSketch_class::setup(void) {
+  hostIo.reset();
+  hostDcc.reset();
+  hostSerial.reset();
+  reboots = 0;
+  loopCycles = 0;
+  maxLoopCycles = 0;
+  start();
+}
+
+
+void hostSketch_class::loop(void) {
+  uint64_t begin = hostIo.cycles;
+  hostDcc.passQueued = 0;
+  try {
+    sketchLoop();
+  }
+  catch (HostReboot &) {
+    reboots++;
+    start();
+  }
+  hostAccess.endCommand();
+  hostIo.advance(HOST_LOOP_CYCLES);
+  loopCycles = hostIo.cycles - begin;
+  if (loopCycles > maxLoopCycles) maxLoopCycles = loopCycles;
+}
+
+
+void hostSketch_class::run(uint32_t ms) {
+  uint64_t end = hostIo.cycles + (uint64_t)ms * (F_CPU / 1000UL);
+  while (hostIo.cycles < end) loop();
+}
+
+
+void hostSketch_class::idle(uint64_t ms) {
+  uint64_t end = hostIo.cycles + ms * (F_CPU / 1000UL);
+  while (hostIo.cycles < end) {
+    loop();
+    if (!hostDcc.queue.empty() || (hostIo.cycles >= end)) continue;
+    uint64_t step = (uint64_t)HOST_IDLE_MS * (F_CPU / 1000UL);
+    if (step > end - hostIo.cycles) step = end - hostIo.cycles;
+    uint64_t next = hostIo.nextAction();
+    if (next < hostIo.cycles + step) step = (next > hostIo.cycles) ? next - hostIo.cycles : 0;
+    hostIo.advance(step);
+  }
+}
+
+
+uint16_t hostSketch_class::relayPins(void) {
+  uint16_t result = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    if (hostIo.pin(relayPin[i])) result |= (1 << i);
+  }
+  return result;
+}
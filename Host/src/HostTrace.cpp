@@ -0,0 +1,189 @@
+//*****************************************************************************************************
+//
+// File:      HostTrace.cpp
+// Author:    Aiko Pras
+// History:   2026/02/17 AP Version 1.0
+//
+// Purpose:   Records relays, LEDs, button and ADC inputs as a Value Change Dump (see Host.h)
+//
+// The virtual clock restarts at each hostSketch.setup(); the trace continues after the last event
+// instead, so that its time never runs backwards.
+//
+//*****************************************************************************************************
+#include <stdlib.h>
+#include "Host.h"
+#include "Hardware.h"
+
+hostTrace_class hostTrace;
+
+#define SIG_RELAY1      0
+#define SIG_LED_DCC     16
+#define SIG_LED_ACC     17
+#define SIG_LED_PROG    18
+#define SIG_LED_ERROR   19
+#define SIG_BUTTON      20
+#define SIG_ADC1        21
+#define SIGNALS         37
+
+static const uint8_t relayPin[16] = {
+  RELAY1, RELAY2, RELAY3, RELAY4, RELAY5, RELAY6, RELAY7, RELAY8,
+  RELAY9, RELAY10, RELAY11, RELAY12, RELAY13, RELAY14, RELAY15, RELAY16
+};
+
+static const uint8_t relayAdc[16] = {
+  ADC_RELAY1, ADC_RELAY2, ADC_RELAY3, ADC_RELAY4, ADC_RELAY5, ADC_RELAY6, ADC_RELAY7, ADC_RELAY8,
+  ADC_RELAY9, ADC_RELAY10, ADC_RELAY11, ADC_RELAY12, ADC_RELAY13, ADC_RELAY14, ADC_RELAY15, ADC_RELAY16
+};
+
+
+static uint8_t width(uint8_t signal) {
+  if ((signal == SIG_LED_DCC) || (signal == SIG_LED_ACC)) return 8;
+  return (signal >= SIG_ADC1) ? 12 : 1;
+}
+
+
+static void name(uint8_t signal, char *text, size_t size) {
+  static const char *fixed[] = {"led_dcc", "led_acc", "led_prog", "led_error", "button"};
+  if (signal < SIG_LED_DCC) snprintf(text, size, "relay%u", signal - SIG_RELAY1 + 1);
+  else if (signal < SIG_ADC1) snprintf(text, size, "%s", fixed[signal - SIG_LED_DCC]);
+  else snprintf(text, size, "adc_relay%u", signal - SIG_ADC1 + 1);
+}
+
+
+// The VCD identifier of a signal: one letter, which no VCD reader mistakes for a keyword or time
+static char code(uint8_t signal) {
+  static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+  return letters[signal];
+}
+
+
+// A PWM LED shows the duty cycle while TCA0 drives its pin, and the pin level otherwise
+static uint16_t pwmLed(uint8_t pin, uint8_t enable, uint8_t compare) {
+  if (TCA0.SPLIT.CTRLB.value & enable) return compare;
+  return hostIo.pin(pin) ? 255 : 0;
+}
+
+
+static uint16_t level(uint8_t signal) {
+  if (signal < SIG_LED_DCC) return hostIo.pin(relayPin[signal - SIG_RELAY1]);
+  switch (signal) {
+    case SIG_LED_DCC:   return pwmLed(LED_DCC, TCA_SPLIT_HCMP2EN_bm, TCA0.SPLIT.HCMP2.value);
+    case SIG_LED_ACC:   return pwmLed(LED_ACC, TCA_SPLIT_HCMP1EN_bm, TCA0.SPLIT.HCMP1.value);
+    case SIG_LED_PROG:  return hostIo.pin(LED_PROG);
+    case SIG_LED_ERROR: return hostIo.pin(LED_ERROR);
+    case SIG_BUTTON:    return hostIo.pin(buttonPin);
+  }
+  uint16_t value = hostIo.analog(relayAdc[signal - SIG_ADC1]);
+  return (value > 0xFFF) ? 0xFFF : value;
+}
+
+
+static void writeValue(FILE *file, uint8_t signal, uint16_t value) {
+  uint8_t bits = width(signal);
+  if (bits == 1) {
+    fprintf(file, "%u%c\n", value ? 1 : 0, code(signal));
+    return;
+  }
+  char text[20];
+  char *p = text;
+  *p++ = 'b';
+  for (int8_t bit = bits - 1; bit >= 0; bit--) *p++ = (value & (1 << bit)) ? '1' : '0';
+  *p = 0;
+  fprintf(file, "%s %c\n", text, code(signal));
+}
+
+
+static uint64_t ns(uint64_t cycles) {
+  return cycles * 1000 / (F_CPU / 1000000UL);
+}
+
+
+//*****************************************************************************************************
+// Open and close
+//*****************************************************************************************************
+bool hostTrace_class::open(const char *fileName, size_t bufferEvents) {
+  close();
+  file = fopen(fileName, "w");
+  if (file == NULL) return false;
+  buffer = (HostTraceEvent *)malloc(bufferEvents * sizeof(HostTraceEvent));
+  size = bufferEvents;
+  used = 0;
+  events = 0;
+  offset = 0;
+  latest = hostIo.cycles;
+  written = latest;
+  fprintf(file, "$timescale 1ns $end\n");
+  fprintf(file, "$scope module tmc16 $end\n");
+  for (uint8_t signal = 0; signal < SIGNALS; signal++) {
+    char text[16];
+    name(signal, text, sizeof(text));
+    uint8_t bits = width(signal);
+    if (bits == 1) fprintf(file, "$var wire 1 %c %s $end\n", code(signal), text);
+    else fprintf(file, "$var wire %u %c %s [%u:0] $end\n", bits, code(signal), text, bits - 1);
+  }
+  fprintf(file, "$upscope $end\n$enddefinitions $end\n");
+  fprintf(file, "#%llu\n$dumpvars\n", (unsigned long long)ns(written));
+  for (uint8_t signal = 0; signal < SIGNALS; signal++) {
+    last[signal] = level(signal);
+    writeValue(file, signal, last[signal]);
+  }
+  fprintf(file, "$end\n");
+  return true;
+}
+
+
+void hostTrace_class::close(void) {
+  if (file == NULL) return;
+  flush();
+  // The end of the simulation, so that the viewer shows the last values up to there
+  uint64_t end = hostIo.cycles + offset;
+  if (ns(end) > ns(written)) fprintf(file, "#%llu\n", (unsigned long long)ns(end));
+  fclose(file);
+  file = NULL;
+  free(buffer);
+  buffer = NULL;
+}
+
+
+//*****************************************************************************************************
+// Recording
+//*****************************************************************************************************
+void hostTrace_class::comparePins(void) {
+  for (uint8_t signal = 0; signal < SIG_ADC1; signal++) {
+    uint16_t value = level(signal);
+    if (value != last[signal]) add(signal, value);
+  }
+}
+
+
+void hostTrace_class::compareAnalog(uint8_t muxpos, uint16_t value) {
+  if (value > 0xFFF) value = 0xFFF;
+  for (uint8_t i = 0; i < 16; i++) {
+    if ((relayAdc[i] == (muxpos & 0x3F)) && (value != last[SIG_ADC1 + i])) add(SIG_ADC1 + i, value);
+  }
+}
+
+
+void hostTrace_class::add(uint8_t signal, uint16_t value) {
+  uint64_t now = hostIo.cycles + offset;
+  if (now < latest) {
+    offset += latest - now;
+    now = latest;
+  }
+  if (used == size) flush();
+  buffer[used++] = {now, value, signal};
+  last[signal] = value;
+  latest = now;
+  events++;
+}
+
+
+void hostTrace_class::flush(void) {
+  for (size_t i = 0; i < used; i++) {
+    const HostTraceEvent &event = buffer[i];
+    if (ns(event.cycles) != ns(written)) fprintf(file, "#%llu\n", (unsigned long long)ns(event.cycles));
+    written = event.cycles;
+    writeValue(file, event.signal, event.value);
+  }
+  used = 0;
+}
@@ -0,0 +1,121 @@
+//*****************************************************************************************************
+//
+// File:      Layout.h
+// Author:    Aiko Pras
+// History:   2026/02/20 AP Version 1.0
+//
+// Purpose:   Boards of a simulated layout: their addresses, their power up and demo traffic
+//
+// Shared by the tools that run many boards, each on a copy of the library per thread (tmc_layout,
+// tmc_power). Board n (0..) has the addresses of DECODER n + 1 in MyDefaults.h: decoder addresses
+// 132 + 4n up to 135 + 4n. NUM_ADDRESSES boards fit below the accessory broadcast address (decoder
+// address 511, see Bulk.h); the boards after that repeat the addresses from the first board on.
+//
+// A LayoutWorker holds the library copy of one thread, and the default EEPROM image, as the
+// decoder writes it at its first power up. powerUp() starts a board from that image, with its
+// own CV1 / CV9. runBoards() is the thread function: it takes boards from a shared counter, and
+// runs them one after the other.
+//
+// The demo traffic has two routes: all relays of all boards on, and a second later all off again.
+// Each accessory command is sent twice, with the time it takes on the bus.
+//
+//*****************************************************************************************************
+#pragma once
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include "Host.h"
+#include "PacketLog.h"
+#include "core_CvValues.h"
+
+#define FIRST_DECODER 132                          // Decoder address of board 1 (DECODER 1)
+#define NUM_ADDRESSES 94                           // Boards with their own addresses
+#define ROUTE_GAP_MS  1000                         // Demo: time between the two routes
+
+static inline uint16_t decoderOf(size_t board) {
+  return FIRST_DECODER + 4 * (board % NUM_ADDRESSES);
+}
+
+
+//*****************************************************************************************************
+// Demo traffic
+//*****************************************************************************************************
+// Time on the bus: 14 preamble bits, a start bit per byte and the end bit. A one takes 116 us,
+// a zero 200 us
+static inline double busTime(const uint8_t *data, uint8_t length) {
+  uint32_t ones = 14 + 1;
+  uint32_t zeros = length;
+  for (uint8_t i = 0; i < length; i++) {
+    for (uint8_t b = 0; b < 8; b++) (data[i] & (1 << b)) ? ones++ : zeros++;
+  }
+  return ones * 116.0 + zeros * 200.0;
+}
+
+
+static inline void addAccessory(PacketLog &traffic, double &us, uint16_t outputAddress, uint8_t position) {
+  uint16_t address = (outputAddress - 1) >> 2;
+  uint8_t port = (outputAddress - 1) & 0x03;
+  Packet packet = {};
+  packet.length = 3;
+  packet.data[0] = 0x80 | (address & 0x3F);
+  packet.data[1] = 0x80 | ((~address >> 2) & 0x70) | 0x08 | (port << 1) | position;
+  packet.data[2] = packet.data[0] ^ packet.data[1];
+  for (uint8_t repeat = 0; repeat < 2; repeat++) {   // Command stations repeat every command
+    us += busTime(packet.data, packet.length);
+    packet.us = us;
+    traffic.packets.push_back(packet);
+  }
+}
+
+
+static inline void demoTraffic(PacketLog &traffic, size_t numBoards) {
+  size_t addresses = (numBoards < NUM_ADDRESSES) ? numBoards : NUM_ADDRESSES;
+  double us = 0;
+  for (uint8_t position = 1; ; position = 0) {
+    size_t first = traffic.packets.size();
+    for (size_t board = 0; board < addresses; board++) {
+      for (uint8_t relay = 0; relay < 16; relay++) {
+        addAccessory(traffic, us, decoderOf(board) * 4 + 1 + relay, position);
+      }
+    }
+    traffic.markers.push_back({traffic.packets[first].us, position ? "all relays on" : "all relays off"});
+    if (position == 0) break;
+    us += ROUTE_GAP_MS * 1000.0;
+  }
+}
+
+
+//*****************************************************************************************************
+// Workers
+//*****************************************************************************************************
+struct LayoutWorker {
+  const HostBoard *api;
+  std::vector<uint8_t> defaults;                   // EEPROM image after setup() with erased EEPROM
+
+  void loadDefaults(void) {
+    memset(api->eeprom, 0xFF, E2END + 1);
+    api->setup();
+    defaults.assign(api->eeprom, api->eeprom + E2END + 1);
+  }
+
+  // Power up with the board's own address
+  void powerUp(uint16_t decoderAddress) {
+    memcpy(api->eeprom, defaults.data(), defaults.size());
+    api->eeprom[myAddrL] = (decoderAddress + 1) & 0x3F;
+    api->eeprom[myAddrH] = (decoderAddress + 1) >> 6;
+    api->setup();
+  }
+};
+
+
+// Worker is a LayoutWorker (or derived from it); run() is called once for each board
+template <typename Worker, typename Board>
+static void runBoards(Worker *worker, std::vector<Board> *boards, std::atomic<size_t> *next,
+                      void (*run)(Worker &worker, Board &board)) {
+  worker->loadDefaults();
+  for (;;) {
+    size_t index = (*next)++;
+    if (index >= boards->size()) return;
+    run(*worker, (*boards)[index]);
+  }
+}
@@ -0,0 +1,42 @@
+//*****************************************************************************************************
+//
+// File:      LibraryCopy.h
+// Author:    Aiko Pras
+// History:   2026/02/18 AP Version 1.0
+//
+// Purpose:   Loads a private copy of libtmcdecoder, for tools that run decoders in several threads
+//
+// The sources keep their state in globals, so each thread needs its own copy of the library (see
+// Host.h, hostBoard()). dlopen() returns the same copy for the same file, so the file is copied
+// first, to a name of its own; the copy is removed once it is loaded, since the mapping stays.
+// Tools that use this do not link the library; CMake passes its path as TMC_LIBRARY.
+//
+//*****************************************************************************************************
+#pragma once
+#include <dlfcn.h>
+#include <unistd.h>
+#include <stdio.h>
+#include "Host.h"
+
+// Returns the table of the copy, or NULL (with a message) if it could not be loaded
+static inline const HostBoard *loadLibraryCopy(const char *tool, size_t index) {
+  char name[64];
+  snprintf(name, sizeof(name), "/tmp/%s.%d.%zu.so", tool, (int)getpid(), index);
+  FILE *from = fopen(TMC_LIBRARY, "rb");
+  FILE *to = fopen(name, "wb");
+  bool ok = (from != NULL) && (to != NULL);
+  char buffer[65536];
+  size_t n;
+  while (ok && ((n = fread(buffer, 1, sizeof(buffer), from)) > 0)) ok = (fwrite(buffer, 1, n, to) == n);
+  if (from) fclose(from);
+  if (to) fclose(to);
+  void *library = ok ? dlopen(name, RTLD_NOW | RTLD_LOCAL | RTLD_DEEPBIND) : NULL;
+  unlink(name);
+  if (library == NULL) {
+    printf("Cannot load %s: %s\n", TMC_LIBRARY, ok ? dlerror() : "copy failed");
+    return NULL;
+  }
+  typedef const HostBoard *(*hostBoard_t)(void);
+  hostBoard_t hostBoardOf = (hostBoard_t)dlsym(library, "hostBoard");
+  return hostBoardOf ? hostBoardOf() : NULL;
+}
@@ -0,0 +1,178 @@
+//*****************************************************************************************************
+//
+// File:      PacketLog.h
+// Author:    Aiko Pras
+// History:   2026/02/14 AP Version 1.0
+//            2026/02/19 AP Version 1.1: PacketStream, for traces that do not fit in memory
+//            2026/02/20 AP Version 1.2: writePackets
+//
+// Purpose:   Reading DCC traffic from a file, for the tools that replay it, and writing it
+//
+// File formats (one entry per line, empty lines and lines starting with # are skipped):
+// - packets:  <time in us> <byte> <byte> ...   bytes in hex, error detection byte included;
+//             the time is that of the end bit, when the ISR of AP_DCC_library delivers the packet
+//             A line "@ <name>" marks the start of a route: the packets up to the next @ line
+// - edges:    <time in us>                     every edge of the DCC signal, as a logic analyser
+//                                              records it on the DCC input pin
+// Edge times are turned into packets by HostDccBits, as the ISR would. tmc_layout does not link
+// the decoder library (it loads a copy per thread, see HostBoard.cpp), so it only reads packets.
+// PacketLog reads the whole file. PacketStream reads one packet at a time, for traces of a whole
+// operating session; its packets must be in order of time. writePackets() writes the packets and
+// the markers in the packet format, for instance traffic that a tool made itself (Layout.h).
+//
+//*****************************************************************************************************
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Host.h"
+
+struct Packet {
+  double us;
+  uint8_t length;
+  uint8_t data[HOST_DCC_MAX_BYTES];
+};
+
+struct Marker {
+  double us;                                       // Time of the first packet of the route
+  std::string name;
+};
+
+class PacketLog {
+  public:
+    std::vector<Packet> packets;                   // In order of time
+    std::vector<Marker> markers;
+    uint32_t lines = 0;                            // Entries in the file
+    uint32_t tooLong = 0;                          // Packet lines with more than HOST_DCC_MAX_BYTES
+
+    static bool skipLine(const char *line) {
+      while ((*line == ' ') || (*line == '\t')) line++;
+      return (*line == '#') || (*line == '\n') || (*line == '\r') || (*line == 0);
+    }
+
+    static std::string markerName(const char *line) {
+      std::string name = line + 1;
+      name.erase(0, name.find_first_not_of(" \t"));
+      name.erase(name.find_last_not_of(" \t\r\n") + 1);
+      return name;
+    }
+
+    // Returns false if the packet has more than HOST_DCC_MAX_BYTES
+    static bool parsePacket(const char *line, Packet &packet) {
+      char *p;
+      packet = {};
+      packet.us = strtod(line, &p);
+      for (;;) {
+        char *next;
+        unsigned long value = strtoul(p, &next, 16);
+        if (next == p) break;
+        p = next;
+        if (packet.length == HOST_DCC_MAX_BYTES) return false;
+        packet.data[packet.length++] = (uint8_t)value;
+      }
+      return true;
+    }
+
+    void readPackets(FILE *file) {
+      char line[256];
+      while (fgets(line, sizeof(line), file)) {
+        if (skipLine(line)) continue;
+        if (line[0] == '@') {
+          markers.push_back({-1, markerName(line)});
+          continue;
+        }
+        lines++;
+        Packet packet;
+        if (!parsePacket(line, packet)) tooLong++;
+        else packets.push_back(packet);
+        if (!markers.empty() && (markers.back().us < 0)) markers.back().us = packet.us;
+      }
+      // A log file that was edited by hand may not be in order of time
+      std::stable_sort(packets.begin(), packets.end(),
+                       [](const Packet &a, const Packet &b) {return a.us < b.us;});
+    }
+
+    // Returns the number of bit errors
+    uint32_t readEdges(FILE *file, HostDccBits &bits) {
+      char line[256];
+      bits.reset();
+      double last = -1;
+      while (fgets(line, sizeof(line), file)) {
+        if (skipLine(line)) continue;
+        lines++;
+        double edge = strtod(line, NULL);
+        if (last >= 0) {
+          double half = edge - last;
+          if (bits.halfBit((half < 0) ? 0 : (uint32_t)(half + 0.5))) {
+            Packet packet = {};
+            packet.us = edge;
+            packet.length = bits.length;
+            memcpy(packet.data, bits.data, bits.length);
+            packets.push_back(packet);
+          }
+        }
+        last = edge;
+      }
+      return bits.errors;
+    }
+
+    // Returns false if the file cannot be written
+    bool writePackets(const char *name) const {
+      FILE *file = fopen(name, "w");
+      if (file == NULL) return false;
+      size_t marker = 0;
+      for (const Packet &packet : packets) {
+        for (; (marker < markers.size()) && (markers[marker].us <= packet.us); marker++) {
+          fprintf(file, "@ %s\n", markers[marker].name.c_str());
+        }
+        fprintf(file, "%.0f", packet.us);
+        for (uint8_t i = 0; i < packet.length; i++) fprintf(file, " %02X", packet.data[i]);
+        fprintf(file, "\n");
+      }
+      fclose(file);
+      return true;
+    }
+};
+
+
+class PacketStream {
+  public:
+    uint32_t lines = 0;
+    uint32_t tooLong = 0;
+    std::string marker;                            // "@" line before the last packet; else empty
+
+    bool open(const char *name) {
+      file = fopen(name, "r");
+      return file != NULL;
+    }
+
+    void close(void) {
+      if (file) fclose(file);
+      file = NULL;
+    }
+
+    // false: end of the file
+    bool next(Packet &packet) {
+      char line[256];
+      marker.clear();
+      while (file && fgets(line, sizeof(line), file)) {
+        if (PacketLog::skipLine(line)) continue;
+        if (line[0] == '@') {
+          marker = PacketLog::markerName(line);
+          continue;
+        }
+        lines++;
+        if (PacketLog::parsePacket(line, packet)) return true;
+        tooLong++;
+      }
+      return false;
+    }
+
+    ~PacketStream() {close();}
+
+  private:
+    FILE *file = NULL;
+};
@@ -0,0 +1,29 @@
+//*****************************************************************************************************
+//
+// File:      TmcBench.cpp
+// Author:    Aiko Pras
+// History:   2026/02/15 AP Version 1.0
+//
+// Purpose:   Runs the benchmark suite (Code/Benchmark.h) on the host
+//
+// Usage:     tmc_bench [calls]           (default: BENCH_CALLS per round)
+//
+// The decoder is started as usual, after which benchmark.run() prints one JSON object per line
+// to stdout, in the same format as the board sends over Serial.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include "Host.h"
+#include "Benchmark.h"
+
+
+int main(int argc, char *argv[]) {
+  uint16_t calls = (argc > 1) ? atoi(argv[1]) : BENCH_CALLS;
+  hostSketch.setup();
+  hostSketch.idle(1000);
+  hostSerial.clear();
+  benchmark.run(calls);
+  fputs(hostSerial.output.c_str(), stdout);
+  return 0;
+}
@@ -0,0 +1,102 @@
+//*****************************************************************************************************
+//
+// File:      TmcBudget.cpp
+// Author:    Aiko Pras
+// History:   2026/02/16 AP Version 1.0
+//
+// Purpose:   Checks the hardware accesses per DCC command against a budget
+//
+// Usage:     tmc_budget [-v]
+//            -v       list the call sites of each command, also if it stays within its budget
+//
+// Each scenario sends one DCC command to a decoder that has been running for a while, and counts
+// the hardware accesses of the loop() pass that processes it (hostAccess, command window). A count
+// above its budget is a slow path that crept into the command handling: the call sites of that
+// command are listed, and the program exits with 1, so that it can run in CI on each commit.
+// The EEPROM starts erased, thus with the defaults of MyDefaults.h. Since the default PrintDetails
+// is 0, commands print nothing; the budgets for Serial bytes would catch a forgotten debug print.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <string.h>
+#include "Host.h"
+
+#define FIRST_OUTPUT    529                        // Output address of relay 1 (MyDefaults.h)
+#define OTHER_OUTPUT    1                          // Output address of another decoder
+#define CV_PULSE_TIME   75
+#define ANY             0xFFFF                     // Not checked
+
+struct Scenario {
+  const char *name;
+  void (*send)(void);
+  uint16_t budget[HOST_ACCESS_TYPES];              // In the order of HostAccessType
+};
+
+
+static void accessoryOn(void) {hostDcc.accessory(FIRST_OUTPUT + 1, 1);}
+static void accessoryOff(void) {hostDcc.accessory(FIRST_OUTPUT + 1, 0);}
+static void otherDecoder(void) {hostDcc.accessory(OTHER_OUTPUT, 1);}
+static void pomVerify(void) {
+  hostDcc.pom(accCmd.myAddress, CV_PULSE_TIME, EEPROM.data[CV_PULSE_TIME], CvAccess::verifyByte);
+}
+static void pomWrite(void) {
+  hostDcc.pom(accCmd.myAddress, CV_PULSE_TIME, EEPROM.data[CV_PULSE_TIME] + 1);
+}
+
+//                                                EEPROM       digital      millis micros Serial ADC
+//                                                read  write  read  write
+static const Scenario scenarios[] = {
+  {"accessory, this decoder",    accessoryOn,   { 0,    0,     ANY,  ANY,   1,     0,     0,     ANY}},
+  {"accessory, repetition",      accessoryOn,   { 0,    0,     ANY,  ANY,   1,     0,     0,     ANY}},
+  {"accessory, deactivate",      accessoryOff,  { 0,    0,     ANY,  ANY,   1,     0,     0,     ANY}},
+  {"accessory, other decoder",   otherDecoder,  { 0,    0,     ANY,  ANY,   1,     0,     0,     ANY}},
+  {"PoM verify",                 pomVerify,     { 1,    0,     ANY,  ANY,   1,     0,     0,     ANY}},
+  {"PoM write",                  pomWrite,      { ANY,  1,     ANY,  ANY,   ANY,   0,     0,     ANY}},
+};
+
+
+static void listSites(const std::map<HostAccessSite, uint32_t> &sites) {
+  for (const auto &site : sites) {
+    printf("      %-15s %6u  %s\n", hostAccess_class::typeName(site.first.second), site.second,
+           hostAccess_class::siteName(site.first.first).c_str());
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  bool verbose = (argc > 1) && !strcmp(argv[1], "-v");
+  EEPROM.erase();
+  hostSketch.setup();
+  hostSketch.run(200);
+  hostAccess.clear();
+  hostAccess.enabled = true;
+
+  uint32_t violations = 0;
+  printf("%-28s", "Command");
+  for (uint8_t type = 0; type < HOST_ACCESS_TYPES; type++) printf(" %15s", hostAccess_class::typeName(type));
+  printf("\n");
+  for (const Scenario &scenario : scenarios) {
+    uint32_t windows = hostAccess.commands;
+    scenario.send();
+    hostSketch.run(20);
+    if (hostAccess.commands == windows) {
+      printf("%-28s not returned by dcc.input()\n", scenario.name);
+      violations++;
+      continue;
+    }
+    bool over = false;
+    printf("%-28s", scenario.name);
+    for (uint8_t type = 0; type < HOST_ACCESS_TYPES; type++) {
+      uint16_t budget = scenario.budget[type];
+      bool exceeded = (budget != ANY) && (hostAccess.cmdCount[type] > budget);
+      if (budget == ANY) printf(" %9u      ", hostAccess.cmdCount[type]);
+      else printf(" %9u/%-3u%s", hostAccess.cmdCount[type], budget, exceeded ? " !" : "  ");
+      if (exceeded) over = true;
+    }
+    printf("\n");
+    if (over) violations++;
+    if (over || verbose) listSites(hostAccess.cmdSites);
+  }
+  printf("%u of %u commands over budget\n", violations, (unsigned)(sizeof(scenarios) / sizeof(scenarios[0])));
+  return violations ? 1 : 0;
+}
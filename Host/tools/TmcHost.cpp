@@ -0,0 +1,30 @@
+//*****************************************************************************************************
+//
+// File:      TmcHost.cpp
+// Author:    Aiko Pras
+// History:   2026/02/10 AP Version 1.0
+//
+// Purpose:   Runs the decoder on the host, and switches relays via accessory commands
+//
+// Usage:     tmc_host [address position] ...
+//            Each pair sends a basic accessory command (position 0 = -, 1 = +), then runs the
+//            decoder for 100 ms virtual time and prints the relay pins.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include "Host.h"
+
+int main(int argc, char *argv[]) {
+  hostSerial.echo = true;
+  hostSketch.setup();
+  hostSketch.run(100);
+  for (int i = 1; i + 1 < argc; i += 2) {
+    uint16_t address = atoi(argv[i]);
+    uint8_t position = atoi(argv[i + 1]);
+    hostDcc.accessory(address, position);
+    hostSketch.run(100);
+    printf("\n%u %u: relays 0x%04X\n", address, position, hostSketch.relayPins());
+  }
+  return 0;
+}
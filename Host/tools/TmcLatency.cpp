@@ -0,0 +1,71 @@
+//*****************************************************************************************************
+//
+// File:      TmcLatency.cpp
+// Author:    Aiko Pras
+// History:   2026/02/11 AP Version 1.0
+//            2026/02/17 AP Version 1.1: Optional waveform file
+//
+// Purpose:   Predicts the worst-case loop latency and the shortcut detection latency
+//
+// The decoder starts with an erased EEPROM, switches all relays on and off, receives a few PoM
+// writes, and then switches relay 1 on while its ADC input reads as a shortcut. The times follow
+// from the peripheral models in HostIo.cpp (ADC conversion, EEPROM write, USART byte time).
+//
+// Usage:     tmc_latency [vcd]
+//            vcd      also write the relays, LEDs, button and ADC inputs to a Value Change Dump,
+//                     to see the relay switching, the shortcut and the LED feedback in GTKWave
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include "Host.h"
+#include "Hardware.h"
+
+#define FIRST_OUTPUT  529                          // Output address of relay 1 (MyDefaults.h)
+#define CV_PULSE_TIME 75
+
+static double us(uint64_t cycles) {
+  return (double)cycles / (F_CPU / 1000000UL);
+}
+
+
+int main(int argc, char *argv[]) {
+  hostSketch.setup();
+  if ((argc > 1) && !hostTrace.open(argv[1])) {
+    printf("Cannot open %s\n", argv[1]);
+    return 2;
+  }
+  printf("setup (erased EEPROM):   %10.1f us\n", us(hostIo.cycles));
+  hostSketch.run(100);
+  hostSketch.maxLoopCycles = 0;
+
+  // Relay commands
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    uint8_t position = (pass == 0);                // First all on, then all off
+    for (uint8_t relay = 0; relay < 16; relay++) {
+      hostDcc.accessory(FIRST_OUTPUT + relay, position);
+      hostSketch.run(20);
+    }
+  }
+  printf("loop latency, relays:    %10.1f us\n", us(hostSketch.maxLoopCycles));
+
+  // PoM writes, directly after each other
+  hostSketch.maxLoopCycles = 0;
+  hostDcc.pom(accCmd.myAddress, CV_PULSE_TIME, 30);
+  hostDcc.pom(accCmd.myAddress, CV_PULSE_TIME, 25);
+  hostSketch.run(100);
+  printf("loop latency, PoM:       %10.1f us\n", us(hostSketch.maxLoopCycles));
+
+  // Shortcut on relay 1
+  hostIo.setAnalog(ADC_RELAY1, 1023);
+  uint64_t sent = hostIo.cycles;
+  hostDcc.accessory(FIRST_OUTPUT, 1);
+  hostSketch.run(20);
+  if (hostSketch.relayPins() & 0x0001) printf("shortcut not detected\n");
+  else {
+    printf("shortcut, relay on:      %10.1f us\n", us(hostIo.fallen[RELAY1] - hostIo.risen[RELAY1]));
+    printf("shortcut, from command:  %10.1f us\n", us(hostIo.fallen[RELAY1] - sent));
+  }
+  printf("serial wait, total:      %10.1f us\n", us(hostSerial.waitCycles));
+  hostTrace.close();
+  return 0;
+}
@@ -0,0 +1,210 @@
+//*****************************************************************************************************
+//
+// File:      TmcLayout.cpp
+// Author:    Aiko Pras
+// History:   2026/02/14 AP Version 1.0
+//            2026/02/18 AP Version 1.1: Library copies via LibraryCopy.h
+//            2026/02/20 AP Version 1.2: Addresses, demo traffic and workers in Layout.h
+//
+// Purpose:   Simulates a layout with many decoder boards on one DCC bus
+//
+// Usage:     tmc_layout [-b boards] [-t threads] [-v] [file]
+//            -b boards   number of boards (default 9)
+//            -t threads  worker threads (default: the number of CPUs)
+//            -v          one line per board
+//            file        DCC traffic as a packet log (PacketLog.h); "@ <name>" lines mark routes.
+//                        Without a file, two routes are sent: all relays of all boards on, then off
+//
+// Board n (1..) has the addresses of DECODER n in MyDefaults.h: decoder addresses 128 + 4n up to
+// 131 + 4n, so board 1 switches outputs 529..544. 94 boards fit below the accessory broadcast
+// address (decoder address 511, see Bulk.h); board 95 and up repeat the addresses of board 1 and
+// up. Each board has its own EEPROM image (the defaults, with its own CV1 / CV9) and its own
+// relays, and sees the same packets at the same time.
+//
+// Each worker thread loads its own copy of libtmcdecoder (see Host.h, HostBoard.cpp), and runs
+// the boards it takes from a shared counter one after the other, each for the whole traffic.
+// This is possible since boards do not influence each other: they only listen to the bus. The
+// traffic is shared by all threads, and only read.
+//
+// For each route the report gives the reaction time of the layout: the time from the first packet
+// of the route until the last relay of any board changed, and which board that was.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "Host.h"
+#include "PacketLog.h"
+#include "LibraryCopy.h"
+#include "Layout.h"
+
+#define START_MS      200                          // Time after setup() before the first packet
+#define END_MS        200                          // Time after the last packet
+#define CHUNK_MS      10                           // Packets are scheduled per chunk of time
+
+struct Board {
+  uint16_t decoderAddress;
+  uint16_t relays;                                 // At the end
+  uint32_t inputs;
+  uint32_t dropped;
+  uint64_t maxLatency;
+  uint32_t reboots;
+  std::vector<uint64_t> lastChange;                // Per route: cycles after its start, 0: none
+  std::vector<uint32_t> changes;                   // Per route: relay pin changes
+};
+
+typedef LayoutWorker Worker;
+
+static PacketLog traffic;
+static std::vector<Board> boards;
+static std::atomic<size_t> nextBoard(0);
+
+
+static double ms(uint64_t cycles) {
+  return (double)cycles / (F_CPU / 1000UL);
+}
+
+
+static uint64_t toCycles(double us) {
+  return (uint64_t)(us * (F_CPU / 1000000UL));
+}
+
+
+//*****************************************************************************************************
+// Workers
+//*****************************************************************************************************
+static void runBoard(Worker &worker, Board &board) {
+  const HostBoard *api = worker.api;
+  const std::vector<Packet> &packets = traffic.packets;
+  const std::vector<Marker> &markers = traffic.markers;
+
+  worker.powerUp(board.decoderAddress);
+  uint64_t start = api->io->cycles + (uint64_t)START_MS * (F_CPU / 1000UL);
+  while (api->io->cycles < start) api->loop();
+  uint32_t inputs = api->dcc->inputs;
+
+  double first = packets.front().us;
+  uint64_t end = start + toCycles(packets.back().us - first) + (uint64_t)END_MS * (F_CPU / 1000UL);
+  board.lastChange.assign(markers.size(), 0);
+  board.changes.assign(markers.size(), 0);
+  uint16_t relays = api->relayPins();
+  size_t next = 0;                                 // First packet not yet scheduled
+  size_t route = 0;                                // Route of the current time, if any
+  while (api->io->cycles < end) {
+    uint64_t chunkEnd = api->io->cycles + (uint64_t)CHUNK_MS * (F_CPU / 1000UL);
+    for (; (next < packets.size()) && (start + toCycles(packets[next].us - first) < chunkEnd); next++) {
+      api->packet(start + toCycles(packets[next].us - first), packets[next].data, packets[next].length);
+    }
+    while (api->io->cycles < chunkEnd) {
+      api->loop();
+      uint16_t now = api->relayPins();
+      if (now == relays) continue;
+      uint64_t t = api->io->cycles - start;
+      while ((route + 1 < markers.size()) && (t >= toCycles(markers[route + 1].us - first))) route++;
+      if (!markers.empty() && (t >= toCycles(markers[route].us - first))) {
+        board.lastChange[route] = t - toCycles(markers[route].us - first);
+        board.changes[route] += __builtin_popcount(now ^ relays);
+      }
+      relays = now;
+    }
+  }
+  board.relays = relays;
+  board.inputs = api->dcc->inputs - inputs;
+  board.dropped = api->dcc->dropped;
+  board.maxLatency = api->dcc->latencyMax;
+  board.reboots = api->sketch->reboots;
+}
+
+
+//*****************************************************************************************************
+// Main
+//*****************************************************************************************************
+int main(int argc, char *argv[]) {
+  size_t numBoards = 9;
+  size_t numThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+  bool verbose = false;
+  const char *name = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-b") && (i + 1 < argc)) numBoards = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-t") && (i + 1 < argc)) numThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-v")) verbose = true;
+    else name = argv[i];
+  }
+  if ((numBoards == 0) || (numThreads == 0)) {
+    printf("Usage: tmc_layout [-b boards] [-t threads] [-v] [file]\n");
+    return 2;
+  }
+  if (numThreads > numBoards) numThreads = numBoards;
+  if (name) {
+    FILE *file = fopen(name, "r");
+    if (file == NULL) {
+      printf("Cannot open %s\n", name);
+      return 2;
+    }
+    traffic.readPackets(file);
+    fclose(file);
+  }
+  else demoTraffic(traffic, numBoards);
+  if (traffic.packets.empty()) {
+    printf("No packets\n");
+    return 2;
+  }
+  boards.resize(numBoards);
+  for (size_t i = 0; i < numBoards; i++) boards[i].decoderAddress = decoderOf(i);
+
+  std::vector<Worker> workers(numThreads);
+  for (size_t i = 0; i < numThreads; i++) {
+    workers[i].api = loadLibraryCopy("tmc_layout", i);
+    if (workers[i].api == NULL) return 2;
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (Worker &worker : workers) threads.emplace_back(runBoards<Worker, Board>, &worker, &boards, &nextBoard, runBoard);
+  for (std::thread &thread : threads) thread.join();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  double seconds = (traffic.packets.back().us - traffic.packets.front().us) / 1e6;
+  printf("Boards:                  %10zu  (%zu threads)\n", numBoards, numThreads);
+  printf("Packets:                 %10zu  (%.3f s on the bus)\n", traffic.packets.size(), seconds);
+  printf("Wall time:               %10.3f s  (%.1f board seconds per second)\n", wall,
+         numBoards * seconds / wall);
+  for (size_t route = 0; route < traffic.markers.size(); route++) {
+    uint64_t worst = 0;
+    size_t last = 0;
+    uint32_t changes = 0;
+    for (size_t i = 0; i < numBoards; i++) {
+      changes += boards[i].changes[route];
+      if (boards[i].lastChange[route] > worst) {worst = boards[i].lastChange[route]; last = i;}
+    }
+    if (changes) printf("Route %-18s %10.3f ms  (last: board %zu, %u relay changes)\n",
+                        traffic.markers[route].name.c_str(), ms(worst), last + 1, changes);
+    else printf("Route %-18s    no relay changes\n", traffic.markers[route].name.c_str());
+  }
+  uint32_t dropped = 0;
+  uint32_t reboots = 0;
+  uint64_t maxLatency = 0;
+  for (const Board &board : boards) {
+    dropped += board.dropped;
+    reboots += board.reboots;
+    if (board.maxLatency > maxLatency) maxLatency = board.maxLatency;
+  }
+  printf("Packets dropped:         %10u  (all boards)\n", dropped);
+  printf("Input latency, maximum:  %10.3f ms\n", ms(maxLatency));
+  printf("Reboots:                 %10u\n", reboots);
+  if (verbose) {
+    for (size_t i = 0; i < numBoards; i++) {
+      const Board &board = boards[i];
+      uint32_t changes = 0;
+      for (uint32_t n : board.changes) changes += n;
+      printf("Board %3zu: outputs %4u..%4u, relays 0x%04X, %u commands, %u dropped, %u relay changes\n",
+             i + 1, board.decoderAddress * 4 + 1, board.decoderAddress * 4 + 16, board.relays,
+             board.inputs, board.dropped, changes);
+    }
+  }
+  return 0;
+}
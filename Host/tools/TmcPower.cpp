@@ -0,0 +1,392 @@
+//*****************************************************************************************************
+//
+// File:      TmcPower.cpp
+// Author:    Aiko Pras
+// History:   2026/02/19 AP Version 1.0
+//            2026/02/20 AP Version 1.1: Addresses, demo traffic and workers in Layout.h;
+//                                       a route's peak is what it adds to the current at its start
+//
+// Purpose:   Current drawn from the shared 48 V relay supply by many boards, over a DCC trace
+//
+// Usage:     tmc_power [-b boards] [-t threads] [-relay mA] [-inrush mA ms] [-l mA] [-r routes] [-x]
+//                      [file]
+//            -b boards      number of boards (default 9), with the addresses of tmc_layout
+//            -t threads     worker threads (default: the number of CPUs)
+//            -relay mA      current of an energised relay (default 48: 48 V through 1000 Ohm)
+//            -inrush mA ms  extra current when a relay is energised, and its time constant
+//                           (default 48 mA, 10 ms); -inrush 0 0 for bare relay coils
+//            -l mA          rating of the supply: report the time above it
+//            -r routes      number of worst routes to list (default 5)
+//            -x             run loop() continuously instead of idle() (slow, for checking)
+//            file           packet log (PacketLog.h), in order of time; "@ <name>" lines mark
+//                           routes. Without a file, all relays of all boards are switched on, and
+//                           a second later off again
+//
+// Every board runs the decoder on the whole trace, so its relays switch with the timing of the
+// decoder itself: the command queue, routes, scripts of the sequencer, pulses that the TCB1 ISR
+// ends. Between DCC commands a board runs hostSketch.idle(), which only delays work that waits
+// for a tick by at most HOST_IDLE_MS. The relay pins are followed via hostIo.pinWatch, at the
+// exact time of each port write. The trace is read as a stream, per board, so its length is only
+// limited by time; a board keeps the relay changes only (time, relays energised, relays released).
+//
+// Each energised relay draws -relay mA, plus an inrush of -inrush mA that decays exponentially.
+// The coil of a telephone relay has no inrush of its own (its current rises slowly, see
+// Hardware.cpp); the default stands for what is wired behind the contacts, such as lamps. After
+// all boards have run, their relay changes are merged in order of time. Between two changes the
+// supply current is a constant plus a decaying exponential, which is integrated exactly: the peak
+// is at a change, and the time above a level follows from the logarithm of the ratio.
+// The peak of a route is the most it adds to the current at its start (its first packet), so that
+// relays that earlier routes left energised do not count; a route that only releases adds nothing.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "Host.h"
+#include "PacketLog.h"
+#include "LibraryCopy.h"
+#include "Layout.h"
+
+#define START_MS      200                          // Time after setup() before the first packet
+#define END_MS        1000                         // Time after the last packet
+#define CHUNK_MS      10                           // Packets are scheduled per chunk of time
+#define PEAK_SHARE    0.9                          // The duration of the peak: time above 90%
+
+// A change of the relays of one board, at cycles after the first packet of the trace
+struct Change {
+  uint64_t cycles;
+  uint8_t energised;
+  uint8_t released;
+};
+
+struct Board {
+  uint16_t decoderAddress;
+  std::vector<Change> changes;
+  uint32_t inputs;
+  uint32_t dropped;
+};
+
+// State of the board that a worker is running, for its pin watch
+struct Watch {
+  const HostBoard *api;
+  Board *board;
+  uint64_t start;
+  uint16_t relays;
+};
+
+struct Worker : LayoutWorker {
+  Watch watch;
+};
+
+struct Route {
+  std::string name;
+  uint64_t start;                                  // cycles after the first packet
+  double base;                                     // mA at the start
+  double peak;                                     // mA above base
+  uint64_t peakAt;                                 // cycles after the start of the route
+  uint32_t relaysOn;                               // At the peak
+};
+
+static const char *traceName;
+static bool exact = false;
+static double relayMa = 48;
+static double inrushMa = 48;
+static double inrushMs = 10;
+static std::vector<Board> boards;
+static std::atomic<size_t> nextBoard(0);
+
+
+static double ms(uint64_t cycles) {
+  return (double)cycles / (F_CPU / 1000UL);
+}
+
+
+static uint64_t toCycles(double us) {
+  return (uint64_t)(us * (F_CPU / 1000000UL));
+}
+
+
+//*****************************************************************************************************
+// Workers
+//*****************************************************************************************************
+static void relayWatch(void *context, uint8_t port) {
+  Watch &watch = *(Watch *)context;
+  if (port > 2) return;                            // Relays are on PORTA .. PORTC
+  uint16_t now = watch.api->relayPins();
+  if (now == watch.relays) return;
+  uint64_t cycles = watch.api->io->cycles;
+  uint64_t at = (cycles > watch.start) ? cycles - watch.start : 0;
+  watch.board->changes.push_back({at, (uint8_t)__builtin_popcount(now & ~watch.relays),
+                                  (uint8_t)__builtin_popcount(watch.relays & ~now)});
+  watch.relays = now;
+}
+
+
+static void runFor(const HostBoard *api, uint64_t ms) {
+  if (!exact) {
+    api->idle(ms);
+    return;
+  }
+  uint64_t end = api->io->cycles + ms * (F_CPU / 1000UL);
+  while (api->io->cycles < end) api->loop();
+}
+
+
+static void runBoard(Worker &worker, Board &board) {
+  const HostBoard *api = worker.api;
+  worker.powerUp(board.decoderAddress);
+  runFor(api, START_MS);
+  uint32_t inputs = api->dcc->inputs;
+
+  // From here on, relay changes count
+  Watch &watch = worker.watch;
+  watch = {api, &board, api->io->cycles, 0};
+  relayWatch(&watch, 0);                           // Relays that setup() energised
+  api->io->pinWatchContext = &watch;
+  api->io->pinWatch = relayWatch;
+
+  PacketStream stream;
+  stream.open(traceName);
+  Packet packet;
+  bool pending = stream.next(packet);
+  double first = pending ? packet.us : 0;
+  while (pending) {
+    uint64_t chunkEnd = api->io->cycles + (uint64_t)CHUNK_MS * (F_CPU / 1000UL);
+    for (; pending && (watch.start + toCycles(packet.us - first) < chunkEnd); pending = stream.next(packet)) {
+      api->packet(watch.start + toCycles(packet.us - first), packet.data, packet.length);
+    }
+    runFor(api, CHUNK_MS);
+  }
+  runFor(api, END_MS);
+  api->io->pinWatch = NULL;
+  board.inputs = api->dcc->inputs - inputs;
+  board.dropped = api->dcc->dropped;
+}
+
+
+//*****************************************************************************************************
+// Supply current
+//*****************************************************************************************************
+// Calls segment() for each stretch between two changes of any board: from cycles `at` for
+// `length` cycles, the current is steady + inrush * exp(-t / tau), with `on` relays energised
+template <typename Segment> static void integrate(uint64_t end, Segment segment) {
+  // Merge the changes of all boards, in order of time
+  typedef std::pair<uint64_t, size_t> Head;        // cycles, board
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  std::vector<size_t> next(boards.size(), 0);
+  for (size_t b = 0; b < boards.size(); b++) {
+    if (!boards[b].changes.empty()) heads.push({boards[b].changes[0].cycles, b});
+  }
+  double tau = inrushMs * (F_CPU / 1000UL);        // In cycles
+  uint32_t on = 0;
+  double inrush = 0;
+  uint64_t at = 0;
+  while (!heads.empty()) {
+    uint64_t now = heads.top().first;
+    if (now > at) {
+      segment(at, now - at, on, on * relayMa, inrush);
+      inrush = (tau > 0) ? inrush * exp(-(double)(now - at) / tau) : 0;
+      at = now;
+    }
+    while (!heads.empty() && (heads.top().first == now)) {
+      size_t b = heads.top().second;
+      heads.pop();
+      const Change &change = boards[b].changes[next[b]++];
+      on += change.energised;
+      on -= change.released;
+      inrush += change.energised * inrushMa;
+      if (next[b] < boards[b].changes.size()) heads.push({boards[b].changes[next[b]].cycles, b});
+    }
+  }
+  if (end > at) segment(at, end - at, on, on * relayMa, inrush);
+}
+
+
+// Time within a segment that the current is above level; the current only decreases in a segment
+static double above(double length, double steady, double inrush, double level) {
+  if (steady >= level) return length;
+  if (steady + inrush <= level) return 0;
+  double tau = inrushMs * (F_CPU / 1000UL);
+  double t = tau * log(inrush / (level - steady));
+  return (t < length) ? t : length;
+}
+
+
+//*****************************************************************************************************
+// Main
+//*****************************************************************************************************
+int main(int argc, char *argv[]) {
+  size_t numBoards = 9;
+  size_t numThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+  double limit = 0;
+  size_t numRoutes = 5;
+  bool ok = true;
+  for (int i = 1; ok && (i < argc); i++) {
+    if (!strcmp(argv[i], "-b") && (i + 1 < argc)) numBoards = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-t") && (i + 1 < argc)) numThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-relay") && (i + 1 < argc)) relayMa = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-inrush") && (i + 2 < argc)) {
+      inrushMa = atof(argv[++i]);
+      inrushMs = atof(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-l") && (i + 1 < argc)) limit = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) numRoutes = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-x")) exact = true;
+    else if (argv[i][0] == '-') ok = false;
+    else traceName = argv[i];
+  }
+  if (!ok || (numBoards == 0) || (numThreads == 0)) {
+    printf("Usage: tmc_power [-b boards] [-t threads] [-relay mA] [-inrush mA ms] [-l mA] [-r routes] [-x]\n"
+           "                 [file]\n");
+    return 2;
+  }
+  if (inrushMs <= 0) inrushMa = 0;
+  char demoName[64] = "";
+  if (traceName == NULL) {
+    snprintf(demoName, sizeof(demoName), "/tmp/tmc_power.%d.log", (int)getpid());
+    PacketLog demo;
+    demoTraffic(demo, numBoards);
+    if (!demo.writePackets(demoName)) {
+      printf("Cannot write %s\n", demoName);
+      return 2;
+    }
+    traceName = demoName;
+  }
+
+  // One pass over the trace for its length and its routes
+  PacketStream stream;
+  if (!stream.open(traceName)) {
+    printf("Cannot open %s\n", traceName);
+    return 2;
+  }
+  std::vector<Route> routes;
+  Packet packet;
+  double first = -1;
+  double last = 0;
+  while (stream.next(packet)) {
+    if (first < 0) first = packet.us;
+    if (packet.us < last) {
+      printf("%s: packets are not in order of time (%.0f us)\n", traceName, packet.us);
+      return 2;
+    }
+    last = packet.us;
+    if (!stream.marker.empty()) routes.push_back({stream.marker, toCycles(packet.us - first), 0, 0, 0, 0});
+  }
+  uint32_t numPackets = stream.lines - stream.tooLong;
+  stream.close();
+  if (numPackets == 0) {
+    printf("No packets in %s\n", traceName);
+    return 2;
+  }
+
+  boards.resize(numBoards);
+  for (size_t i = 0; i < numBoards; i++) boards[i].decoderAddress = decoderOf(i);
+  if (numThreads > numBoards) numThreads = numBoards;
+  std::vector<Worker> workers(numThreads);
+  for (size_t i = 0; i < numThreads; i++) {
+    workers[i].api = loadLibraryCopy("tmc_power", i);
+    if (workers[i].api == NULL) return 2;
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (Worker &worker : workers) threads.emplace_back(runBoards<Worker, Board>, &worker, &boards, &nextBoard, runBoard);
+  for (std::thread &thread : threads) thread.join();
+  if (demoName[0]) unlink(demoName);
+
+  // First pass: peak, average, routes
+  uint64_t end = toCycles(last - first) + (uint64_t)END_MS * (F_CPU / 1000UL);
+  double peak = 0;
+  uint64_t peakAt = 0;
+  uint32_t peakOn = 0;
+  double charge = 0;                               // mA x cycles
+  double tau = inrushMs * (F_CPU / 1000UL);
+  size_t route = 0;                                // Last route that started before this segment
+  size_t nextRoute = 0;                            // First route that has not started
+  integrate(end, [&](uint64_t at, uint64_t length, uint32_t on, double steady, double inrush) {
+    double current = steady + inrush;
+    charge += steady * length + ((tau > 0) ? inrush * tau * (1 - exp(-(double)length / tau)) : 0);
+    if (current > peak) {peak = current; peakAt = at; peakOn = on;}
+    // Segments start at a change; the current is highest there. That change belongs to the route
+    // that had started before it, even if the next route starts within this segment
+    if (nextRoute && (current - routes[route].base > routes[route].peak)) {
+      routes[route].peak = current - routes[route].base;
+      routes[route].peakAt = at - routes[route].start;
+      routes[route].relaysOn = on;
+    }
+    // Routes that start within this segment: the current at their start
+    for (; (nextRoute < routes.size()) && (routes[nextRoute].start < at + length); nextRoute++) {
+      uint64_t t = (routes[nextRoute].start > at) ? routes[nextRoute].start - at : 0;
+      routes[nextRoute].base = steady + ((tau > 0) ? inrush * exp(-(double)t / tau) : 0);
+      route = nextRoute;
+    }
+  });
+
+  // Second pass: how long the current stays near the peak, and above the limit
+  double level = PEAK_SHARE * peak;
+  double nearPeak = 0, run = 0, longest = 0;
+  double overLimit = 0, limitRun = 0, longestOver = 0;
+  uint32_t excursions = 0;
+  integrate(end, [&](uint64_t, uint64_t length, uint32_t, double steady, double inrush) {
+    double t = above(length, steady, inrush, level);
+    nearPeak += t;
+    run = (t > 0) ? run + t : 0;
+    if (run > longest) longest = run;
+    if (t < length) run = 0;
+    if (limit > 0) {
+      double u = above(length, steady, inrush, limit);
+      if ((u > 0) && (limitRun == 0)) excursions++;
+      overLimit += u;
+      limitRun = (u > 0) ? limitRun + u : 0;
+      if (limitRun > longestOver) longestOver = limitRun;
+      if (u < length) limitRun = 0;
+    }
+  });
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  size_t numChanges = 0;
+  uint32_t dropped = 0;
+  for (const Board &board : boards) {
+    numChanges += board.changes.size();
+    dropped += board.dropped;
+  }
+  double seconds = ms(end) / 1000;
+  printf("Trace:                   %s (%u packets, %.3f s)\n", demoName[0] ? "demo" : traceName,
+         numPackets, seconds);
+  printf("Boards:                  %10zu  (%zu threads%s)\n", numBoards, numThreads, exact ? ", exact" : "");
+  printf("Wall time:               %10.3f s  (%.1f board seconds per second)\n", wall,
+         numBoards * seconds / wall);
+  printf("Model:                   %10.1f mA per relay, inrush %.1f mA, %.1f ms\n", relayMa, inrushMa, inrushMs);
+  printf("Relay changes:           %10zu  (%u packets dropped)\n", numChanges, dropped);
+  printf("Peak current:            %10.1f mA  at %.3f s, %u relays energised\n", peak, ms(peakAt) / 1000, peakOn);
+  printf("Above %2.0f%% of the peak:   %10.3f ms  (longest stretch %.3f ms)\n", PEAK_SHARE * 100,
+         nearPeak / (F_CPU / 1000UL), longest / (F_CPU / 1000UL));
+  printf("Average current:         %10.1f mA\n", charge / end);
+  if (limit > 0) {
+    printf("Above the limit:         %10.3f ms  (%.0f mA: %u times, longest %.3f ms)\n",
+           overLimit / (F_CPU / 1000UL), limit, excursions, longestOver / (F_CPU / 1000UL));
+  }
+  if (!routes.empty()) {
+    std::vector<size_t> order(routes.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {return routes[a].peak > routes[b].peak;});
+    printf("Worst routes:            (most the route adds to the current at its start)\n");
+    for (size_t i = 0; (i < order.size()) && (i < numRoutes); i++) {
+      const Route &r = routes[order[i]];
+      if (r.peak > 0) {
+        printf("  %-22s %10.1f mA  %.3f ms after its start (from %.1f mA), %u relays energised\n",
+               r.name.c_str(), r.peak, ms(r.peakAt), r.base, r.relaysOn);
+      }
+      else printf("  %-22s %10.1f mA  (from %.1f mA)\n", r.name.c_str(), 0.0, r.base);
+    }
+  }
+  return 0;
+}
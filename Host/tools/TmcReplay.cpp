@@ -0,0 +1,156 @@
+//*****************************************************************************************************
+//
+// File:      TmcReplay.cpp
+// Author:    Aiko Pras
+// History:   2026/02/13 AP Version 1.0
+//            2026/02/17 AP Version 1.1: -w, waveforms
+//            2026/02/20 AP Version 1.2: Command latency, from the end bit until a relay pin changes
+//
+// Purpose:   Replays recorded DCC traffic into the decoder, to reproduce field issues
+//
+// Usage:     tmc_replay [-e] [-r rate] [-w vcd] file
+//            -e       the file holds edge times instead of packets
+//            -w vcd   write the relays, LEDs, button and ADC inputs to a Value Change Dump
+//            -r rate  1 = real time, 10 = ten times faster, ... 0 = as fast as possible (default)
+//
+// The file formats are described in PacketLog.h. Each packet is given to hostDcc.packet() at its
+// own time on the virtual clock, so the decoder sees the same timing whatever the rate; the rate
+// only sets how fast the virtual clock runs compared to the wall clock.
+// The decoder runs loop() continuously (hostSketch.run()), so that a packet arrives somewhere in a
+// loop() pass, as on the real board.
+//
+// The report gives the commands dcc.input() returned per second, the latency from the end bit of
+// a packet until dcc.input() returned it, and the packets that were lost: because the decoder had
+// not yet taken the previous packet (dropped), or because of bit or checksum errors.
+// The relay latency runs from the end bit of a packet until a relay pin changes. The relay ports
+// are followed via hostIo.pinWatch; the first relay change in the loop() pass that took a command
+// from dcc.input() is that command's (hostDcc.passQueued). Repetitions and commands for other
+// decoders change no relay, and are not counted; neither are pulse ends and script steps, which
+// happen in a later pass.
+//
+//*****************************************************************************************************
+#include <chrono>
+#include <thread>
+#include "Host.h"
+#include "PacketLog.h"
+
+#define START_MS   200                             // Time after setup() before the first packet
+#define END_MS     100                             // Time after the last packet
+#define PACE_MS    10                              // Virtual time between two wall clock checks
+
+static PacketLog traffic;
+static uint16_t relays;                            // Relay pins at the last change
+static uint32_t changes;                           // Commands that changed a relay
+static uint64_t changeSum;
+static uint64_t changeMax;
+
+
+static double us(uint64_t cycles) {
+  return (double)cycles / (F_CPU / 1000000UL);
+}
+
+
+static void relayWatch(void *, uint8_t port) {
+  if (port > 2) return;                            // Relays are on PORTA .. PORTC
+  uint16_t now = hostSketch.relayPins();
+  if (now == relays) return;
+  relays = now;
+  if (hostDcc.passQueued == 0) return;             // No command in this pass
+  uint64_t latency = hostIo.cycles - hostDcc.passQueued;
+  hostDcc.passQueued = 0;                          // Only the first change of this command
+  changes++;
+  changeSum += latency;
+  if (latency > changeMax) changeMax = latency;
+}
+
+
+int main(int argc, char *argv[]) {
+  bool edges = false;
+  double rate = 0;
+  const char *name = NULL;
+  const char *vcd = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-e")) edges = true;
+    else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) rate = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-w") && (i + 1 < argc)) vcd = argv[++i];
+    else name = argv[i];
+  }
+  if (name == NULL) {
+    printf("Usage: tmc_replay [-e] [-r rate] [-w vcd] file\n");
+    return 2;
+  }
+  FILE *file = fopen(name, "r");
+  if (file == NULL) {
+    printf("Cannot open %s\n", name);
+    return 2;
+  }
+  HostDccBits bits;
+  uint32_t bitErrors = edges ? traffic.readEdges(file, bits) : 0;
+  if (!edges) traffic.readPackets(file);
+  fclose(file);
+  std::vector<Packet> &packets = traffic.packets;
+  if (packets.empty()) {
+    printf("No packets in %s\n", name);
+    return 2;
+  }
+
+  hostSketch.setup();
+  if (vcd && !hostTrace.open(vcd)) {
+    printf("Cannot open %s\n", vcd);
+    return 2;
+  }
+  hostSketch.idle(START_MS);
+  hostSketch.maxLoopCycles = 0;
+  uint32_t inputs = hostDcc.inputs;
+  relays = hostSketch.relayPins();
+  hostIo.pinWatch = relayWatch;
+  uint64_t start = hostIo.cycles;
+  double first = packets.front().us;
+  double last = packets.back().us;
+  for (const Packet &packet : packets) {
+    uint64_t at = start + (uint64_t)((packet.us - first) * (F_CPU / 1000000UL));
+    hostIo.at(at, [&packet]() {hostDcc.packet(packet.data, packet.length);});
+  }
+
+  // Replay, with the virtual clock paced against the wall clock
+  uint64_t end = start + (uint64_t)((last - first) * (F_CPU / 1000000UL))
+               + (uint64_t)END_MS * (F_CPU / 1000UL);
+  auto wallStart = std::chrono::steady_clock::now();
+  while (hostIo.cycles < end) {
+    hostSketch.run(PACE_MS);
+    if (rate > 0) {
+      double wallUs = us(hostIo.cycles - start) / rate;
+      std::this_thread::sleep_until(wallStart + std::chrono::microseconds((uint64_t)wallUs));
+    }
+  }
+  hostTrace.close();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double virt = us(hostIo.cycles - start) / 1e6;
+
+  uint32_t commands = hostDcc.inputs - inputs;
+  printf("File:                    %s (%u %s)\n", name, traffic.lines, edges ? "edges" : "packets");
+  if (edges) printf("Bit errors:              %10u\n", bitErrors);
+  if (traffic.tooLong) printf("Packets too long:        %10u\n", traffic.tooLong);
+  printf("Packets delivered:       %10u\n", hostDcc.packets);
+  printf("Packets dropped:         %10u  (decoder had not taken the previous one)\n", hostDcc.dropped);
+  printf("Checksum errors:         %10u\n", hostDcc.badChecksum);
+  printf("Packets not returned:    %10u  (idle, speed, other loco, ...)\n",
+         hostDcc.ignored - hostDcc.badChecksum);
+  printf("Commands returned:       %10u\n", commands);
+  printf("Virtual time:            %10.3f s\n", virt);
+  printf("Wall time:               %10.3f s  (%.1f x real time)\n", wall, virt / wall);
+  printf("Commands per second:     %10.1f virtual, %.1f wall\n", commands / virt, commands / wall);
+  if (commands) printf("Input latency, average:  %10.1f us\n", us(hostDcc.latencySum) / commands);
+  printf("Input latency, maximum:  %10.1f us\n", us(hostDcc.latencyMax));
+  printf("Commands that switched:  %10u\n", changes);
+  if (changes) {
+    printf("Relay latency, average:  %10.1f us  (end bit until a relay pin changes)\n",
+           us(changeSum) / changes);
+    printf("Relay latency, maximum:  %10.1f us\n", us(changeMax));
+  }
+  printf("loop() pass, maximum:    %10.1f us\n", us(hostSketch.maxLoopCycles));
+  printf("Reboots:                 %10u\n", hostSketch.reboots);
+  printf("Relay pins at the end:       0x%04X\n", hostSketch.relayPins());
+  if (vcd) printf("Waveform events:         %10llu  (%s)\n", (unsigned long long)hostTrace.events, vcd);
+  return 0;
+}
@@ -0,0 +1,112 @@
+//*****************************************************************************************************
+//
+// File:      TmcSoak.cpp
+// Author:    Aiko Pras
+// History:   2026/02/12 AP Version 1.0
+//
+// Purpose:   Soak run of the decoder across the millis() wrap-around, in virtual time
+//
+// Usage:     tmc_soak [hours]            (default: 2 hours of simulated operation)
+//
+// After setup() the clock is skipped forward to 10 minutes before millis() wraps (49,7 days).
+// From there the decoder receives an accessory command for a random relay every 250 ms, and the
+// relay pins are checked after each command. Around the wrap-around:
+// - a DccTimer of 3 seconds is started 1,5 s before the wrap, and must run for exactly 3 s;
+// - the programming button is pressed 3 s before the wrap and released 5,25 s later. The
+//   decoder must restore its defaults and reboot after 5 s, and not earlier.
+// A watchdog stops the run if a single step takes more than 10 seconds of virtual time, which
+// means that the decoder waits for something that will not come (such as address programming).
+// Returns 0 if all checks passed, 1 otherwise.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "Host.h"
+#include "Hardware.h"
+#include "core_Timer.h"
+
+#define FIRST_OUTPUT  529                          // Output address of relay 1 (MyDefaults.h)
+#define STEP_MS       250                          // Time between two commands
+#define BEFORE_WRAP   (10 * 60000L)                // Start, in ms before the wrap-around
+
+struct Stuck {};                                   // Thrown by the watchdog
+
+static uint32_t seed = 20260212;
+static uint32_t failures = 0;
+static long currentStep;
+static DccTimer timer;
+
+static uint32_t random32(void) {
+  seed = seed * 1664525UL + 1013904223UL;
+  return seed;
+}
+
+
+static void check(bool ok, const char *what, long t) {
+  if (ok) return;
+  printf("FAIL at %+ld ms from the wrap-around: %s\n", t, what);
+  failures++;
+}
+
+
+int main(int argc, char *argv[]) {
+  uint32_t hours = (argc > 1) ? atoi(argv[1]) : 2;
+  auto wallStart = std::chrono::steady_clock::now();
+
+  hostSketch.setup();
+  hostSketch.idle(1000);
+  hostIo.skipToMillis((uint32_t)(0 - BEFORE_WRAP));
+
+  uint16_t expected = hostSketch.relayPins();
+  uint32_t commands = 0;
+  long steps = (long)hours * 3600000L / STEP_MS;
+  for (long step = 0; step < steps; step++) {
+    long t = step * STEP_MS - BEFORE_WRAP;         // ms relative to the wrap-around
+    currentStep = step;
+    hostIo.atMs(STEP_MS + 10000, [step]() {if (currentStep == step) throw Stuck();});
+
+    // The programming button, pressed across the wrap-around. Release happens while the
+    // decoder waits (delay) between restoring the defaults and its reboot
+    if (t == -3000) {
+      hostIo.setPin(buttonPin, LOW);
+      hostIo.atMs(5250, []() {hostIo.setPin(buttonPin, HIGH);});
+    }
+    if (t == 1750) check(hostSketch.reboots == 0, "button: long press detected too early", t);
+    if (t == 3500) {
+      check(hostSketch.reboots == 1, "button: long press not detected", t);
+      expected = 0;                                // Relays are off after the reboot
+    }
+
+    // The DccTimer (checked before the reboot, which restarts millis())
+    if (t == -1500) timer.setTime(3000);
+    if (t == 1000) check(timer.running(), "timer: not running after 2,5 s", t);
+    if (t == 1500) check(timer.expired(), "timer: not expired after 3 s", t);
+
+    // A command for a random relay, except while the button test reboots the decoder
+    if ((t < 1500) || (t > 3500)) {
+      uint8_t relay = random32() % 16;
+      uint8_t position = (random32() >> 8) & 1;
+      hostDcc.accessory(FIRST_OUTPUT + relay, position);
+      if (position) expected |= (1 << relay);
+      else expected &= ~(1 << relay);
+      commands++;
+    }
+    try {
+      hostSketch.idle(STEP_MS);
+    }
+    catch (Stuck &) {
+      check(false, "decoder stuck", t);
+      break;
+    }
+    if ((t < 1500) || (t > 3500)) check(hostSketch.relayPins() == expected, "relays", t);
+    if (failures > 10) break;
+  }
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  printf("Simulated %u h, %u commands, %u reboots, worst loop %.1f us, wall time %.3f s\n",
+         hours, commands, hostSketch.reboots,
+         (double)hostSketch.maxLoopCycles / (F_CPU / 1000000UL), wall);
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,380 @@
+//*****************************************************************************************************
+//
+// File:      TmcThreshold.cpp
+// Author:    Aiko Pras
+// History:   2026/02/18 AP Version 1.0
+//
+// Purpose:   Chooses the shortcut threshold (CV33) from synthetic relay and shortcut currents
+//
+// Usage:     tmc_threshold [-n trials] [-t threads] [-s seed] [-f percent] [-c]
+//                          [-coil ohm ohm] [-henry h h] [-cable m] [-short ohm ohm]
+//                          [-noise counts] [-spikes percent counts]
+//            -n       loads of each kind per setting (default 2000)
+//            -t       worker threads (default: the number of CPUs)
+//            -s       seed of the random loads and noise; equal seeds give equal results
+//            -f       acceptable false trips, in percent of the relays (default 0.1)
+//            -c       all settings as CSV, instead of the summary
+//            the other options give the ranges of the loads and the noise (defaults below)
+//
+// After a relay has been switched on, the decoder converts the ADC input of its channel once,
+// and releases the relay if the result exceeds CV33 (adc_class::shortcut()). Hardware.cpp lists
+// what the ADC reads: a relay coil starts at 0 and needs some 100 ms to reach 48, a resistor of
+// 270 Ohm reads 110. This tool draws relays and shortcuts with random parameters within the given
+// ranges, and runs the conversions of adc_class on their currents, at the times the conversions
+// take place on the virtual clock. Per setting it reports how many relays were taken for a
+// shortcut (false trips), how many shortcuts were not detected, and how long detection took.
+//
+// The current of a load is that of a resistance R in series with an inductance L:
+//   counts(t) = counts(R) * (1 - exp(-t * R / L))
+// - relay:    R = coil + cable, L = coil + cable
+// - shortcut: R = short + cable, L = cable
+// counts(R) interpolates the measurements in Hardware.cpp. The cable is a pair of 0,5 mm2 wires.
+// Its capacitance is left out: it charges in well under a microsecond, before the ADC samples.
+// On top comes noise: Gaussian, plus spikes (switching of other relays, a locomotive passing)
+// that hit a given share of the conversions with up to a given number of counts.
+//
+// Settings are a threshold plus a filter. The firmware has no filter: one conversion directly
+// after switching on. The other filters are candidates: a shortcut needs `samples` conversions in
+// a row above the threshold, the check goes on until `window` after switching on, and there is
+// `spacing` between two conversions. A threshold above 255 cannot be stored in maxValue.
+// Each conversion is done by adc_class::shortcut(); its result (ADC0.RES) is then compared with
+// every threshold of the sweep, which gives the same decision as a call per threshold, on the
+// same noise. Loads and noise depend on the seed and the number of the load only, so all filters
+// see the same loads, and the results do not depend on the number of threads.
+//
+// Work is split in jobs of JOB_LOADS loads for one filter; each worker thread has its own copy of
+// the library (LibraryCopy.h), and takes jobs from a shared counter.
+//
+//*****************************************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include "Host.h"
+#include "Hardware.h"
+#include "LibraryCopy.h"
+
+#define SAMPLE_US       1.0                        // The ADC samples 2 ADC clocks after the start
+#define CABLE_OHM_M     0.069                      // 2 x 0,5 mm2 copper, per metre of cable
+#define CABLE_UH_M      0.7                        // Loop inductance, per metre of cable
+#define FIRST_THRESHOLD 16
+#define LAST_THRESHOLD  254
+#define THRESHOLD_STEP  2
+#define THRESHOLDS      ((LAST_THRESHOLD - FIRST_THRESHOLD) / THRESHOLD_STEP + 1)
+#define JOB_LOADS       250
+#define CHANNEL         ADC_RELAY1
+
+struct Range {
+  double min;
+  double max;
+};
+
+struct Model {
+  Range coilOhm = {800, 1200};
+  Range coilHenry = {2, 5};
+  Range cableMetre = {0, 30};
+  Range shortOhm = {0, 680};
+  double noise = 2;                                // Counts, standard deviation
+  double spikeRate = 1;                            // Percent of the conversions
+  double spikeCounts = 100;                        // Maximum height of a spike
+};
+
+struct Filter {
+  uint8_t samples;                                 // In a row above the threshold
+  double spacingUs;
+  double windowUs;
+};
+
+// Per filter and threshold
+struct Result {
+  uint32_t falseTrips;
+  uint32_t missed;
+  uint64_t latencySum;                             // cycles, of the detected shortcuts
+  uint64_t latencyMax;
+};
+
+struct Load {
+  double counts;                                   // Final value
+  double tau;                                      // Seconds
+};
+
+static const Filter filters[] = {
+  {1, 0, 0}, {2, 0, 0}, {4, 0, 0},
+  {1, 0, 200}, {2, 0, 200}, {4, 0, 200},
+  {1, 100, 1000}, {2, 100, 1000}, {4, 100, 1000}
+};
+#define FILTERS (sizeof(filters) / sizeof(filters[0]))
+
+static Model model;
+static uint32_t numLoads = 2000;
+static uint64_t seed = 1;
+static std::vector<Result> results(FILTERS * THRESHOLDS);
+static std::mutex resultsMutex;
+static std::atomic<size_t> nextJob(0);
+
+
+static uint16_t threshold(size_t index) {
+  return FIRST_THRESHOLD + index * THRESHOLD_STEP;
+}
+
+
+static double us(uint64_t cycles) {
+  return (double)cycles / (F_CPU / 1000000UL);
+}
+
+
+static std::string filterName(const Filter &filter) {
+  char text[64];
+  if ((filter.samples == 1) && (filter.windowUs == 0)) return "1 conversion (firmware)";
+  int n = (filter.samples == 1) ? snprintf(text, sizeof(text), "1 conversion")
+                                 : snprintf(text, sizeof(text), "%u in a row", filter.samples);
+  if (filter.windowUs > 0) {
+    if (filter.spacingUs > 0) n += snprintf(text + n, sizeof(text) - n, ", every %.0f us", filter.spacingUs);
+    snprintf(text + n, sizeof(text) - n, ", for %.0f us", filter.windowUs);
+  }
+  return text;
+}
+
+
+//*****************************************************************************************************
+// Loads
+//*****************************************************************************************************
+// ADC counts of a resistive load, from the measurements in Hardware.cpp, interpolated in
+// conductance (mS); below 270 Ohm the last segment is extended
+static const double measuredMs[] = {0, 1000.0 / 3300, 1000.0 / 1000, 1000.0 / 680, 1000.0 / 270};
+static const double measuredCounts[] = {0, 11, 42, 59, 110};
+
+static double countsOf(double ohm) {
+  double ms = 1000.0 / ((ohm < 1) ? 1 : ohm);
+  uint8_t i = 1;
+  while ((i < 4) && (ms > measuredMs[i])) i++;
+  double slope = (measuredCounts[i] - measuredCounts[i - 1]) / (measuredMs[i] - measuredMs[i - 1]);
+  return measuredCounts[i - 1] + (ms - measuredMs[i - 1]) * slope;
+}
+
+
+static double draw(std::mt19937_64 &random, const Range &range) {
+  return std::uniform_real_distribution<double>(range.min, range.max)(random);
+}
+
+
+static Load makeLoad(uint32_t index, bool isShort) {
+  std::mt19937_64 random(seed * 1000003 + index * 2 + isShort);
+  double cable = draw(random, model.cableMetre);
+  double ohm = cable * CABLE_OHM_M;
+  double henry = cable * CABLE_UH_M * 1e-6;
+  if (isShort) ohm += draw(random, model.shortOhm);
+  else {
+    ohm += draw(random, model.coilOhm);
+    henry += draw(random, model.coilHenry);
+  }
+  if (ohm < 1) ohm = 1;
+  return {countsOf(ohm), henry / ohm};
+}
+
+
+static uint16_t input(const Load &load, double seconds, std::mt19937_64 &noise) {
+  double value = load.counts * ((load.tau > 0) ? 1 - exp(-seconds / load.tau) : 1);
+  value += std::normal_distribution<double>(0, model.noise)(noise);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  if (uniform(noise) * 100 < model.spikeRate) value += uniform(noise) * model.spikeCounts;
+  if (value < 0) return 0;
+  return (value > 1023) ? 1023 : (uint16_t)(value + 0.5);
+}
+
+
+//*****************************************************************************************************
+// Workers
+//*****************************************************************************************************
+// Switches the load on, and runs the check of the filter. trip[i]: cycles after switching on at
+// which threshold i released the relay, 0 = not released
+static void check(const HostBoard *api, const Filter &filter, const Load &load, std::mt19937_64 &noise,
+                  uint64_t *trip) {
+  uint8_t inRow[THRESHOLDS] = {};
+  uint64_t start = api->io->cycles;
+  uint64_t spacing = (uint64_t)(filter.spacingUs * (F_CPU / 1000000UL));
+  uint64_t window = (uint64_t)(filter.windowUs * (F_CPU / 1000000UL));
+  size_t open = THRESHOLDS;                        // Thresholds that have not tripped
+  for (uint32_t k = 0; open; k++) {
+    uint64_t now = api->io->cycles - start;
+    if ((k >= filter.samples) && (now > window)) break;
+    double seconds = (double)now / F_CPU + SAMPLE_US * 1e-6;
+    api->setAnalog(CHANNEL, input(load, seconds, noise));
+    uint16_t result;
+    api->shortcut(CHANNEL, 255, &result);
+    uint64_t done = api->io->cycles - start;
+    for (size_t i = 0; i < THRESHOLDS; i++) {
+      if (trip[i]) continue;
+      if (result <= threshold(i)) {
+        inRow[i] = 0;
+        continue;
+      }
+      if (++inRow[i] < filter.samples) continue;
+      trip[i] = done;
+      open--;
+    }
+    if (spacing) api->advance(spacing);
+  }
+}
+
+
+static void runJob(const HostBoard *api, size_t job) {
+  size_t jobsPerFilter = (numLoads + JOB_LOADS - 1) / JOB_LOADS;
+  size_t f = job / jobsPerFilter;
+  uint32_t first = (job % jobsPerFilter) * JOB_LOADS;
+  uint32_t last = (first + JOB_LOADS < numLoads) ? first + JOB_LOADS : numLoads;
+  Result local[THRESHOLDS] = {};
+  for (uint32_t index = first; index < last; index++) {
+    for (uint8_t isShort = 0; isShort < 2; isShort++) {
+      Load load = makeLoad(index, isShort);
+      std::mt19937_64 noise(seed * 7919 + index * 2 + isShort);
+      uint64_t trip[THRESHOLDS] = {};
+      check(api, filters[f], load, noise, trip);
+      for (size_t i = 0; i < THRESHOLDS; i++) {
+        if (!isShort) {
+          if (trip[i]) local[i].falseTrips++;
+        }
+        else if (!trip[i]) local[i].missed++;
+        else {
+          local[i].latencySum += trip[i];
+          if (trip[i] > local[i].latencyMax) local[i].latencyMax = trip[i];
+        }
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(resultsMutex);
+  for (size_t i = 0; i < THRESHOLDS; i++) {
+    Result &result = results[f * THRESHOLDS + i];
+    result.falseTrips += local[i].falseTrips;
+    result.missed += local[i].missed;
+    result.latencySum += local[i].latencySum;
+    if (local[i].latencyMax > result.latencyMax) result.latencyMax = local[i].latencyMax;
+  }
+}
+
+
+static void work(const HostBoard *api, size_t jobs) {
+  memset(api->eeprom, 0xFF, E2END + 1);
+  api->setup();                                    // Initialises the ADC as the decoder does
+  for (;;) {
+    size_t job = nextJob++;
+    if (job >= jobs) return;
+    runJob(api, job);
+  }
+}
+
+
+//*****************************************************************************************************
+// Main
+//*****************************************************************************************************
+static bool range(int argc, char *argv[], int &i, Range &value) {
+  if (i + 2 >= argc) return false;
+  value.min = atof(argv[++i]);
+  value.max = atof(argv[++i]);
+  return value.max >= value.min;
+}
+
+
+static void printResult(const Filter &filter, size_t i, const Result &result) {
+  uint32_t detected = numLoads - result.missed;
+  printf("%-38s %9u %10.2f%% %8.2f%%", filterName(filter).c_str(), threshold(i),
+         100.0 * result.falseTrips / numLoads, 100.0 * result.missed / numLoads);
+  if (detected) printf(" %9.1f us %7.1f us\n", us(result.latencySum) / detected, us(result.latencyMax));
+  else printf("         -          -\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  size_t numThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+  double target = 0.1;
+  bool csv = false;
+  bool ok = true;
+  for (int i = 1; ok && (i < argc); i++) {
+    if (!strcmp(argv[i], "-n") && (i + 1 < argc)) numLoads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-t") && (i + 1 < argc)) numThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) seed = strtoull(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "-f") && (i + 1 < argc)) target = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-c")) csv = true;
+    else if (!strcmp(argv[i], "-coil")) ok = range(argc, argv, i, model.coilOhm);
+    else if (!strcmp(argv[i], "-henry")) ok = range(argc, argv, i, model.coilHenry);
+    else if (!strcmp(argv[i], "-short")) ok = range(argc, argv, i, model.shortOhm);
+    else if (!strcmp(argv[i], "-cable") && (i + 1 < argc)) model.cableMetre.max = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-noise") && (i + 1 < argc)) model.noise = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-spikes") && (i + 2 < argc)) {
+      model.spikeRate = atof(argv[++i]);
+      model.spikeCounts = atof(argv[++i]);
+    }
+    else ok = false;
+  }
+  if (!ok || (numLoads == 0) || (numThreads == 0)) {
+    printf("Usage: tmc_threshold [-n trials] [-t threads] [-s seed] [-f percent] [-c]\n"
+           "                     [-coil ohm ohm] [-henry h h] [-cable m] [-short ohm ohm]\n"
+           "                     [-noise counts] [-spikes percent counts]\n");
+    return 2;
+  }
+  size_t jobs = FILTERS * ((numLoads + JOB_LOADS - 1) / JOB_LOADS);
+  if (numThreads > jobs) numThreads = jobs;
+
+  std::vector<const HostBoard *> apis(numThreads);
+  for (size_t i = 0; i < numThreads; i++) {
+    apis[i] = loadLibraryCopy("tmc_threshold", i);
+    if (apis[i] == NULL) return 2;
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (const HostBoard *api : apis) threads.emplace_back(work, api, jobs);
+  for (std::thread &thread : threads) thread.join();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  uint8_t cv33 = apis[0]->eeprom[33];              // Shortcut, as set by MyDefaults.h
+
+  if (csv) {
+    printf("samples,spacing_us,window_us,threshold,false_trips,missed,latency_avg_us,latency_max_us\n");
+    for (size_t f = 0; f < FILTERS; f++) {
+      for (size_t i = 0; i < THRESHOLDS; i++) {
+        const Result &result = results[f * THRESHOLDS + i];
+        uint32_t detected = numLoads - result.missed;
+        printf("%u,%.0f,%.0f,%u,%.6f,%.6f,%.2f,%.2f\n", filters[f].samples, filters[f].spacingUs,
+               filters[f].windowUs, threshold(i), (double)result.falseTrips / numLoads,
+               (double)result.missed / numLoads, detected ? us(result.latencySum) / detected : 0,
+               us(result.latencyMax));
+      }
+    }
+    return 0;
+  }
+
+  printf("Relays:                  %u, coil %.0f..%.0f Ohm, %.1f..%.1f H\n", numLoads,
+         model.coilOhm.min, model.coilOhm.max, model.coilHenry.min, model.coilHenry.max);
+  printf("Shortcuts:               %u, %.0f..%.0f Ohm\n", numLoads, model.shortOhm.min, model.shortOhm.max);
+  printf("Cable:                   %.0f..%.0f m\n", model.cableMetre.min, model.cableMetre.max);
+  printf("Noise:                   %.1f counts rms, spikes on %.1f%% of the conversions, up to %.0f counts\n",
+         model.noise, model.spikeRate, model.spikeCounts);
+  printf("Settings:                %zu filters x %u thresholds, %zu threads, %.2f s\n",
+         FILTERS, THRESHOLDS, numThreads, wall);
+  printf("\nFirmware, CV33 = %u:\n", cv33);
+  printf("%-38s %9s %11s %9s %12s %10s\n", "Filter", "Threshold", "False trips", "Missed", "Latency", "max");
+  if ((cv33 >= FIRST_THRESHOLD) && (cv33 <= LAST_THRESHOLD) && !((cv33 - FIRST_THRESHOLD) % THRESHOLD_STEP)) {
+    size_t i = (cv33 - FIRST_THRESHOLD) / THRESHOLD_STEP;
+    printResult(filters[0], i, results[i]);
+  }
+  printf("\nBest threshold per filter, with at most %.2f%% false trips:\n", target);
+  printf("%-38s %9s %11s %9s %12s %10s\n", "Filter", "Threshold", "False trips", "Missed", "Latency", "max");
+  for (size_t f = 0; f < FILTERS; f++) {
+    // Fewest missed shortcuts; of these the lowest threshold, which detects soonest
+    size_t best = THRESHOLDS;
+    for (size_t i = 0; i < THRESHOLDS; i++) {
+      const Result &result = results[f * THRESHOLDS + i];
+      if (100.0 * result.falseTrips / numLoads > target) continue;
+      if ((best == THRESHOLDS) || (result.missed < results[f * THRESHOLDS + best].missed)) best = i;
+    }
+    if (best == THRESHOLDS) printf("%-38s   none meets the target\n", filterName(filters[f]).c_str());
+    else printResult(filters[f], best, results[f * THRESHOLDS + best]);
+  }
+  return 0;
+}